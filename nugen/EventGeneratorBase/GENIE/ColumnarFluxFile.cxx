@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  ColumnarFluxFile.cxx
+/// \brief Compact, memory mapped flux ray file
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include <unistd.h>
+
+// NuGen includes
+#include "nugen/EventGeneratorBase/GENIE/ColumnarFluxFile.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+
+// Framework includes
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace {
+
+  const char     kMagic[8]  = { 'E','V','G','B','C','F','L','X' };
+  const uint64_t kAlignment = 64;
+
+  uint64_t Align(uint64_t n) { return ( n + kAlignment - 1 ) / kAlignment * kAlignment; }
+
+  const char* const kColumnNames[evgb::ColumnarFluxFile::kNColumns] = {
+    "pdg", "wgt", "E", "px", "py", "pz", "x", "y", "z", "dist",
+    "ptype", "ndecay", "ppmedium", "tptype",
+    "vx", "vy", "vz", "pdpx", "pdpy", "pdpz", "pppx", "pppy", "pppz",
+    "tpx", "tpy", "tpz"
+  };
+
+}
+
+namespace evgb {
+
+  static_assert(sizeof(ColumnarFluxHeader)   == 128, "ColumnarFluxHeader layout");
+  static_assert(sizeof(ColumnarFluxDirEntry) ==  16, "ColumnarFluxDirEntry layout");
+
+  const uint32_t ColumnarFluxFile::kVersion;
+
+  //--------------------------------------------------
+  ColumnarFluxFile::ColumnarFluxFile()
+    : fHeader(nullptr)
+  {
+    std::fill(fCols,fCols+kNColumns,nullptr);
+  }
+
+  //--------------------------------------------------
+  ColumnarFluxFile::~ColumnarFluxFile()
+  {
+  }
+
+  //--------------------------------------------------
+  const char* ColumnarFluxFile::ColumnName(Column_t c)
+  {
+    return ( c < kNColumns ) ? kColumnNames[c] : "unknown";
+  }
+
+  //--------------------------------------------------
+  bool ColumnarFluxFile::Open(std::string const& path)
+  {
+    fPath   = path;
+    fHeader = nullptr;
+    std::fill(fCols,fCols+kNColumns,nullptr);
+    fMap.reset(new util::MappedFile(path));
+
+    const char* data = fMap->Data();
+    size_t      size = fMap->Size();
+    if ( ! fMap->IsOpen() || size < sizeof(ColumnarFluxHeader) ) {
+      mf::LogError("ColumnarFluxFile") << "can't map " << path;
+      return false;
+    }
+    const ColumnarFluxHeader* hdr = reinterpret_cast<const ColumnarFluxHeader*>(data);
+    if ( std::memcmp(hdr->magic,kMagic,sizeof(kMagic)) != 0 || hdr->version != kVersion ) {
+      mf::LogError("ColumnarFluxFile")
+        << path << " is not a version " << kVersion << " columnar flux file";
+      return false;
+    }
+    size_t dirEnd = sizeof(ColumnarFluxHeader) + hdr->ncolumns*sizeof(ColumnarFluxDirEntry);
+    if ( dirEnd > size ) {
+      mf::LogError("ColumnarFluxFile") << path << " is truncated";
+      return false;
+    }
+
+    const ColumnarFluxDirEntry* dir =
+      reinterpret_cast<const ColumnarFluxDirEntry*>(data+sizeof(ColumnarFluxHeader));
+    for ( uint32_t i = 0; i < hdr->ncolumns; ++i ) {
+      // columns written by newer versions of the tool are just skipped
+      if ( dir[i].id >= kNColumns ) continue;
+      if ( dir[i].offset % kAlignment != 0 ||
+           dir[i].offset + hdr->nrays*sizeof(float) > size ) {
+        mf::LogError("ColumnarFluxFile")
+          << path << ": bad offset for column " << ColumnName(Column_t(dir[i].id));
+        return false;
+      }
+      fCols[dir[i].id] = reinterpret_cast<const float*>(data+dir[i].offset);
+    }
+    for ( int c = 0; c < kNRequired; ++c ) {
+      if ( ! fCols[c] ) {
+        mf::LogError("ColumnarFluxFile")
+          << path << " lacks the " << ColumnName(Column_t(c)) << " column";
+        return false;
+      }
+    }
+
+    fHeader = hdr;
+    return true;
+  }
+
+  //--------------------------------------------------
+  std::vector<int> ColumnarFluxFile::Flavors() const
+  {
+    std::vector<int> flavors;
+    if ( ! fHeader ) return flavors;
+    for ( int pdg : fHeader->flavors ) {
+      if ( pdg != 0 ) flavors.push_back(pdg);
+    }
+    return flavors;
+  }
+
+  //--------------------------------------------------
+  bool ColumnarFluxFile::Write(std::string const& path,
+                               std::vector< std::vector<float> > const& columns,
+                               double pot, int fluxtype)
+  {
+    if ( columns.size() < size_t(kNRequired) ) return false;
+    uint64_t nrays = columns[kPdg].size();
+
+    ColumnarFluxHeader hdr;
+    std::memset(&hdr,0,sizeof(hdr));
+    std::memcpy(hdr.magic,kMagic,sizeof(kMagic));
+    hdr.version = kVersion;
+    hdr.nrays   = nrays;
+    hdr.pot     = pot;
+    hdr.fluxtype = fluxtype;
+
+    std::vector<ColumnarFluxDirEntry> dir;
+    for ( size_t c = 0; c < columns.size() && c < size_t(kNColumns); ++c ) {
+      if ( columns[c].empty() && c >= size_t(kNRequired) ) continue;
+      if ( columns[c].size() != nrays ) {
+        mf::LogError("ColumnarFluxFile")
+          << "column " << ColumnName(Column_t(c)) << " has " << columns[c].size()
+          << " values, expected " << nrays;
+        return false;
+      }
+      ColumnarFluxDirEntry entry = { uint32_t(c), 0, 0 };
+      dir.push_back(entry);
+    }
+    hdr.ncolumns = dir.size();
+    uint64_t offset = Align(sizeof(hdr) + dir.size()*sizeof(ColumnarFluxDirEntry));
+    for ( auto& entry : dir ) {
+      entry.offset = offset;
+      offset = Align(offset + nrays*sizeof(float));
+    }
+
+    std::set<int> flavors;
+    for ( uint64_t i = 0; i < nrays; ++i ) {
+      hdr.emax = std::max(hdr.emax,columns[kE][i]);
+      hdr.wmax = std::max(hdr.wmax,columns[kWgt][i]);
+      flavors.insert(int(columns[kPdg][i]));
+    }
+    size_t iflv = 0;
+    for ( int pdg : flavors ) {
+      if ( iflv == 8 ) {
+        mf::LogWarning("ColumnarFluxFile") << "more than 8 flavors, header list truncated";
+        break;
+      }
+      hdr.flavors[iflv++] = pdg;
+    }
+
+    size_t slash = path.find_last_of('/');
+    if ( slash != std::string::npos && slash > 0 ) util::MakeDirs(path.substr(0,slash));
+    std::ostringstream tmpname;
+    tmpname << path << ".tmp." << getpid();
+    std::string tmppath = tmpname.str();
+    {
+      std::ofstream out(tmppath.c_str(),std::ios::binary|std::ios::trunc);
+      if ( ! out ) return false;
+      const char zeros[kAlignment] = { 0 };
+      out.write(reinterpret_cast<const char*>(&hdr),sizeof(hdr));
+      out.write(reinterpret_cast<const char*>(dir.data()),dir.size()*sizeof(ColumnarFluxDirEntry));
+      uint64_t pos = sizeof(hdr) + dir.size()*sizeof(ColumnarFluxDirEntry);
+      for ( auto const& entry : dir ) {
+        out.write(zeros,entry.offset-pos);
+        out.write(reinterpret_cast<const char*>(columns[entry.id].data()),nrays*sizeof(float));
+        pos = entry.offset + nrays*sizeof(float);
+      }
+      out.close();
+      if ( ! out ) {
+        std::remove(tmppath.c_str());
+        return false;
+      }
+    }
+    if ( std::rename(tmppath.c_str(),path.c_str()) != 0 ) {
+      std::remove(tmppath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+} // namespace evgb
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  ColumnarFluxFile.h
+/// \class evgb::ColumnarFluxFile
+/// \brief Compact, memory mapped flux ray file: one float32 array per
+///        quantity (pdg, weight, E, p, x, dist, optionally parentage)
+///
+///        Layout (native byte order):
+///          ColumnarFluxHeader            128 bytes
+///          ColumnarFluxDirEntry[ncol]    16 bytes each
+///          column data                   nrays floats each, 64 byte aligned
+///
+///        The rays are the ones a GENIE flux driver (GSimpleNtpFlux,
+///        GDk2NuFlux, ...) threw for some detector location, in that
+///        driver's user coordinates (meters, GeV); see the
+///        make_columnar_flux tool.  genie::flux::GColumnarFlux replays them.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_COLUMNARFLUXFILE_H
+#define EVGB_COLUMNARFLUXFILE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace evgb {
+
+  namespace util { class MappedFile; }
+
+  struct ColumnarFluxHeader {
+    char     magic[8];      ///< "EVGBCFLX"
+    uint32_t version;
+    uint32_t ncolumns;
+    uint64_t nrays;
+    double   pot;           ///< POT the rays represent (0 = unknown)
+    float    emax;          ///< largest E (GeV)
+    float    wmax;          ///< largest weight
+    int32_t  flavors[8];    ///< pdg codes present (0 = unused slot)
+    int32_t  fluxtype;      ///< simb::Flux_t of the driver the rays came from (0 = unknown)
+    uint8_t  reserved[52];
+  };
+
+  struct ColumnarFluxDirEntry {
+    uint32_t id;            ///< ColumnarFluxFile::Column_t
+    uint32_t reserved;
+    uint64_t offset;        ///< from the start of the file
+  };
+
+  class ColumnarFluxFile {
+
+  public:
+
+    /// ids are stored in files, so only ever append
+    enum Column_t {
+      kPdg = 0, kWgt, kE, kPx, kPy, kPz, kX, kY, kZ, kDist,
+      kNRequired,
+      // parentage (optional)
+      kPtype = kNRequired, kNdecay, kPpmedium, kTptype,
+      kVx, kVy, kVz, kPdpx, kPdpy, kPdpz, kPppx, kPppy, kPppz,
+      kTpx, kTpy, kTpz,
+      kNColumns
+    };
+
+    static const uint32_t kVersion = 2;  ///< 2: weights on the scale of the POT, flux type
+
+    ColumnarFluxFile();
+    ~ColumnarFluxFile();
+
+    /// map the file; false (and a message) if it isn't a usable one
+    bool          Open(std::string const& path);
+
+    std::string   Path()     const { return fPath; }
+    uint64_t      NRays()    const { return fHeader ? fHeader->nrays : 0; }
+    double        POT()      const { return fHeader ? fHeader->pot   : 0; }
+    float         EMax()     const { return fHeader ? fHeader->emax  : 0; }
+    float         WMax()     const { return fHeader ? fHeader->wmax  : 0; }
+    int           FluxType() const { return fHeader ? fHeader->fluxtype : 0; }
+    std::vector<int> Flavors() const;
+
+    /// column data, nullptr if the file doesn't have it
+    const float*  Col(Column_t c) const { return fCols[c]; }
+    bool          HasParentage() const { return fCols[kPtype] != nullptr; }
+
+    static const char* ColumnName(Column_t c);
+
+    /// write a file from per-column arrays (indexed by Column_t; empty
+    /// optional columns are left out, all others need nrays values);
+    /// pot is what the weights as written represent
+    static bool   Write(std::string const& path,
+                        std::vector< std::vector<float> > const& columns,
+                        double pot, int fluxtype);
+
+  private:
+
+    std::string                        fPath;
+    std::unique_ptr<util::MappedFile>  fMap;
+    const ColumnarFluxHeader*          fHeader;
+    const float*                       fCols[kNColumns];
+  };
+
+} // namespace evgb
+
+#endif //EVGB_COLUMNARFLUXFILE_H
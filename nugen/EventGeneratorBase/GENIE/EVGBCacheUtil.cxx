@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  EVGBCacheUtil.cxx
+/// \brief Small helpers for the on-disk caches used by GENIEHelper
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+
+namespace evgb {
+namespace util {
+
+  //--------------------------------------------------
+  uint64_t HashBytes(const void* data, size_t len, uint64_t hash)
+  {
+    const uint64_t kFNVPrime = 1099511628211ULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for ( size_t i = 0; i < len; ++i ) {
+      hash ^= p[i];
+      hash *= kFNVPrime;
+    }
+    return hash;
+  }
+
+  //--------------------------------------------------
+  uint64_t HashString(std::string const& s, uint64_t hash)
+  {
+    // include the length so ("ab","c") and ("a","bc") differ
+    uint64_t len = s.size();
+    hash = HashBytes(&len,sizeof(len),hash);
+    return HashBytes(s.data(),s.size(),hash);
+  }
+
+  //--------------------------------------------------
+  bool HashFile(std::string const& path, uint64_t& hash)
+  {
+    MappedFile mfile(path);
+    if ( ! mfile.IsOpen() ) return false;
+    hash = HashBytes(mfile.Data(),mfile.Size());
+    return true;
+  }
+
+  //--------------------------------------------------
+  bool HashFileSample(std::string const& path, size_t nbytes, uint64_t& hash)
+  {
+    MappedFile mfile(path);
+    if ( ! mfile.IsOpen() ) return false;
+    uint64_t size = mfile.Size();
+    hash = HashBytes(&size,sizeof(size),hash);
+    if ( mfile.Size() <= 2*nbytes ) {
+      hash = HashBytes(mfile.Data(),mfile.Size(),hash);
+    } else {
+      // only these pages get read in
+      hash = HashBytes(mfile.Data(),nbytes,hash);
+      hash = HashBytes(mfile.Data()+mfile.Size()-nbytes,nbytes,hash);
+    }
+    return true;
+  }
+
+  //--------------------------------------------------
+  std::string HashToHex(uint64_t hash)
+  {
+    std::ostringstream s;
+    s << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return s.str();
+  }
+
+  //--------------------------------------------------
+  bool MakeDirs(std::string const& dir)
+  {
+    if ( dir == "" ) return false;
+    struct stat sb;
+    if ( stat(dir.c_str(),&sb) == 0 ) return S_ISDIR(sb.st_mode);
+
+    size_t slash = dir.find_last_of('/');
+    if ( slash != std::string::npos && slash > 0 ) {
+      if ( ! MakeDirs(dir.substr(0,slash)) ) return false;
+    }
+    // someone else might have just made it
+    if ( mkdir(dir.c_str(),0775) != 0 && errno != EEXIST ) return false;
+    return true;
+  }
+
+  //--------------------------------------------------
+  bool AtomicWriteFile(std::string const& path, std::string const& contents)
+  {
+    size_t slash = path.find_last_of('/');
+    if ( slash != std::string::npos && slash > 0 ) {
+      if ( ! MakeDirs(path.substr(0,slash)) ) return false;
+    }
+
+    std::ostringstream tmpname;
+    tmpname << path << ".tmp." << getpid();
+    std::string tmppath = tmpname.str();
+
+    {
+      std::ofstream out(tmppath.c_str(),std::ios::binary|std::ios::trunc);
+      if ( ! out ) return false;
+      out.write(contents.data(),contents.size());
+      out.close();
+      if ( ! out ) {
+        std::remove(tmppath.c_str());
+        return false;
+      }
+    }
+    if ( std::rename(tmppath.c_str(),path.c_str()) != 0 ) {
+      std::remove(tmppath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  //--------------------------------------------------
+  MappedFile::MappedFile(std::string const& path)
+    : fOpen(false)
+    , fData(nullptr)
+    , fSize(0)
+  {
+    int fd = open(path.c_str(),O_RDONLY);
+    if ( fd < 0 ) return;
+    struct stat sb;
+    if ( fstat(fd,&sb) != 0 ) { close(fd); return; }
+    fSize = sb.st_size;
+    if ( fSize > 0 ) {
+      void* addr = mmap(nullptr,fSize,PROT_READ,MAP_PRIVATE,fd,0);
+      if ( addr == MAP_FAILED ) { close(fd); fSize = 0; return; }
+      madvise(addr,fSize,MADV_SEQUENTIAL);
+      fData = static_cast<const char*>(addr);
+    }
+    close(fd);  // the mapping stays valid
+    fOpen = true;
+  }
+
+  //--------------------------------------------------
+  MappedFile::~MappedFile()
+  {
+    if ( fData ) munmap(const_cast<char*>(fData),fSize);
+  }
+
+} // namespace util
+} // namespace evgb
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  EVGBCacheUtil.h
+/// \brief Small helpers for the on-disk caches used by GENIEHelper:
+///        content hashing, read-only memory mapped files and
+///        write-then-rename so readers never see a partial file
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_EVGBCACHEUTIL_H
+#define EVGB_EVGBCACHEUTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace evgb {
+namespace util {
+
+  /// 64-bit FNV-1a; pass a previous result as "hash" to continue it
+  const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+  uint64_t    HashBytes(const void* data, size_t len,
+                        uint64_t hash = kFNVOffsetBasis);
+  uint64_t    HashString(std::string const& s,
+                         uint64_t hash = kFNVOffsetBasis);
+  /// hash of a file's contents; returns false if it can't be read
+  bool        HashFile(std::string const& path, uint64_t& hash);
+  /// continue "hash" with a file's size and its first and last "nbytes"
+  /// bytes; a cheap stand-in for HashFile on large files
+  bool        HashFileSample(std::string const& path, size_t nbytes,
+                             uint64_t& hash);
+  std::string HashToHex(uint64_t hash);   ///< 16 hex digits
+
+  /// write "contents" to a temporary file next to "path" and rename it
+  /// into place; creates missing directories
+  bool        AtomicWriteFile(std::string const& path,
+                              std::string const& contents);
+  bool        MakeDirs(std::string const& dir);
+
+  /// read-only memory mapping of a whole file
+  class MappedFile {
+  public:
+    explicit MappedFile(std::string const& path);
+    ~MappedFile();
+    MappedFile(MappedFile const&)            = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    bool         IsOpen()  const { return fOpen; }  ///< mapped (or empty) file
+    const char*  Data()    const { return fData; }
+    size_t       Size()    const { return fSize; }
+
+  private:
+    bool         fOpen;
+    const char*  fData;
+    size_t       fSize;
+  };
+
+} // namespace util
+} // namespace evgb
+
+#endif //EVGB_EVGBCACHEUTIL_H
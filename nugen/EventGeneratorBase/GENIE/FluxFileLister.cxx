@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxFileLister.cxx
+/// \brief Multi-threaded, cached glob + stat of flux file patterns
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <glob.h>
+#include <sys/stat.h>
+
+// NuGen includes
+#include "nugen/EventGeneratorBase/GENIE/FluxFileLister.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+
+// Framework includes
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace {
+
+  /// run work(i) for i in [0,n) on up to nthreads threads
+  template <typename Func>
+  void ParallelFor(size_t n, int nthreads, Func work)
+  {
+    size_t nt = std::min<size_t>(n,nthreads);
+    if ( nt <= 1 ) {
+      for ( size_t i = 0; i < n; ++i ) work(i);
+      return;
+    }
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < nt; ++t ) {
+      threads.emplace_back([&]() {
+          size_t i;
+          while ( ( i = next.fetch_add(1) ) < n ) work(i);
+        });
+    }
+    for ( auto& thread : threads ) thread.join();
+  }
+
+}
+
+namespace evgb {
+
+  //--------------------------------------------------
+  FluxFileLister::FluxFileLister(int nthreads, std::string const& cachedir,
+                                 double ttl)
+    : fNThreads (nthreads)
+    , fCacheDir (cachedir)
+    , fTTL      (ttl)
+    , fFromCache(false)
+    , fSeconds  (0)
+  {
+    if ( fNThreads <= 0 ) fNThreads = std::thread::hardware_concurrency();
+    if ( fNThreads <= 0 ) fNThreads = 1;
+  }
+
+  //--------------------------------------------------
+  FluxFileLister::FileList_t
+  FluxFileLister::List(std::vector<std::string> const& dirs,
+                       std::vector<std::string> const& patterns,
+                       bool withSizes)
+  {
+    auto start = std::chrono::steady_clock::now();
+    fFromCache = false;
+    fCachePath = "";
+
+    if ( fCacheDir != "" ) {
+      std::ostringstream key;
+      key << ( withSizes ? "sizes" : "names" ) << "\n";
+      for ( auto const& d : dirs     ) key << "dir "     << d << "\n";
+      for ( auto const& p : patterns ) key << "pattern " << p << "\n";
+      fCachePath = fCacheDir + "/evgb-fluxlist-" +
+        evgb::util::HashToHex(evgb::util::HashString(key.str())) + ".txt";
+    }
+
+    FileList_t files;
+    if ( fCachePath != "" && ReadCache(files) ) {
+      fFromCache = true;
+      fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+      mf::LogInfo("FluxFileLister")
+        << "reusing list of " << files.size() << " flux files from " << fCachePath;
+      return files;
+    }
+
+    // one glob() per (pattern, dir) pair, results kept in that order
+    size_t npairs = patterns.size() * dirs.size();
+    std::vector< std::vector<std::string> > matches(npairs);
+    ParallelFor(npairs,fNThreads,[&](size_t ipair) {
+        std::string filepatt = dirs[ipair % dirs.size()] + patterns[ipair / dirs.size()];
+        glob_t g;
+        if ( glob(filepatt.c_str(),GLOB_TILDE,NULL,&g) == 0 ) {
+          matches[ipair].assign(g.gl_pathv,g.gl_pathv+g.gl_pathc);
+        }
+        globfree(&g);
+      });
+    for ( auto const& m : matches ) {
+      for ( auto const& f : m ) files.push_back(std::make_pair(f,-1L));
+    }
+
+    if ( withSizes ) {
+      ParallelFor(files.size(),fNThreads,[&](size_t i) {
+          struct stat sb;
+          if ( stat(files[i].first.c_str(),&sb) == 0 ) files[i].second = sb.st_size;
+        });
+    }
+
+    // an empty list is more likely a transient problem than the truth
+    if ( fCachePath != "" && ! files.empty() ) WriteCache(files);
+
+    fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    mf::LogInfo("FluxFileLister")
+      << "listed " << files.size() << " flux files"
+      << ( withSizes ? " (with sizes)" : "" ) << " in " << fSeconds
+      << " s using " << fNThreads << " threads";
+    return files;
+  }
+
+  //--------------------------------------------------
+  bool FluxFileLister::ReadCache(FileList_t& files) const
+  {
+    struct stat sb;
+    if ( stat(fCachePath.c_str(),&sb) != 0 ) return false;
+    double age = std::difftime(std::time(nullptr),sb.st_mtime);
+    if ( age > fTTL ) {
+      mf::LogDebug("FluxFileLister")
+        << fCachePath << " is " << age << " s old (TTL " << fTTL << " s), relisting";
+      return false;
+    }
+
+    std::ifstream in(fCachePath.c_str());
+    if ( ! in ) return false;
+    FileList_t cached;
+    std::string line;
+    while ( std::getline(in,line) ) {
+      size_t space = line.find(' ');
+      if ( space == std::string::npos ) return false;
+      long size = std::strtol(line.c_str(),nullptr,10);
+      cached.push_back(std::make_pair(line.substr(space+1),size));
+    }
+    if ( cached.empty() ) return false;
+    files.swap(cached);
+    return true;
+  }
+
+  //--------------------------------------------------
+  void FluxFileLister::WriteCache(FileList_t const& files) const
+  {
+    std::ostringstream contents;
+    for ( auto const& f : files ) contents << f.second << " " << f.first << "\n";
+    if ( ! evgb::util::AtomicWriteFile(fCachePath,contents.str()) ) {
+      mf::LogWarning("FluxFileLister") << "couldn't write " << fCachePath;
+    }
+  }
+
+} // namespace evgb
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxFileLister.h
+/// \class evgb::FluxFileLister
+/// \brief Expand flux file patterns (glob) and get the file sizes (stat)
+///        with several threads, optionally caching the result on disk
+///
+///        Every (pattern, directory) pair is a separate glob() and every
+///        file a separate stat(); on network filesystems each of those
+///        is a round trip, so they are spread over a few threads.  The
+///        result keeps the order a serial glob() with GLOB_APPEND gives.
+///
+///        With a cache directory the list is written to
+///        <dir>/evgb-fluxlist-<hash>.txt, and jobs asking for the same
+///        patterns in the same directories reuse it until it is older
+///        than the TTL.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_FLUXFILELISTER_H
+#define EVGB_FLUXFILELISTER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace evgb {
+
+  class FluxFileLister {
+
+  public:
+
+    /// (file name, size in bytes; -1 if not stat'ed)
+    typedef std::vector< std::pair<std::string,long> > FileList_t;
+
+    /// nthreads <= 0 means one per core; cachedir "" = no cache
+    FluxFileLister(int nthreads, std::string const& cachedir, double ttl);
+
+    /// files matching each pattern appended to each directory
+    FileList_t List(std::vector<std::string> const& dirs,
+                    std::vector<std::string> const& patterns,
+                    bool withSizes);
+
+    bool        FromCache() const { return fFromCache; }
+    std::string CachePath() const { return fCachePath; }
+    double      Seconds()   const { return fSeconds;   }
+    int         NThreads()  const { return fNThreads;  }
+
+  private:
+
+    bool ReadCache (FileList_t& files) const;
+    void WriteCache(FileList_t const& files) const;
+
+    int          fNThreads;
+    std::string  fCacheDir;
+    double       fTTL;        ///< seconds
+
+    bool         fFromCache;
+    std::string  fCachePath;
+    double       fSeconds;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_FLUXFILELISTER_H
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxFileStager.cxx
+/// \brief Make local copies of flux files on a background thread
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include <unistd.h>
+
+// NuGen includes
+#include "nugen/EventGeneratorBase/GENIE/FluxFileStager.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+
+// Framework includes
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace evgb {
+
+  //--------------------------------------------------
+  FluxFileStager::FluxFileStager(FileList_t const& files, FetchFunc_t fetch)
+    : fFiles       (files)
+    , fFetch       (fetch)
+    , fLocal       (files.size())
+    , fStop        (false)
+    , fStageSeconds(0)
+    , fWaitSeconds (0)
+  {
+  }
+
+  //--------------------------------------------------
+  FluxFileStager::~FluxFileStager()
+  {
+    Stop();
+  }
+
+  //--------------------------------------------------
+  void FluxFileStager::Start()
+  {
+    if ( fWorker.joinable() ) return;
+    mf::LogInfo("FluxFileStager")
+      << "staging " << fFiles.size() << " flux files in the background";
+    fStart  = std::chrono::steady_clock::now();
+    fWorker = std::thread(&FluxFileStager::Work,this);
+  }
+
+  //--------------------------------------------------
+  void FluxFileStager::Work()
+  {
+    for ( size_t i = 0; i < fFiles.size() && ! fStop; ++i ) {
+      std::string local;
+      try {
+        local = fFetch(fFiles[i].first,fFiles[i].second);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fError = std::current_exception();
+        break;
+      }
+      if ( local == "" ) {
+        mf::LogWarning("FluxFileStager") << "failed to stage " << fFiles[i].first;
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(fMutex);
+      fLocal[i] = local;
+    }
+    fStageSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now()-fStart).count();
+  }
+
+  //--------------------------------------------------
+  std::vector<std::string> FluxFileStager::WaitAll()
+  {
+    auto start = std::chrono::steady_clock::now();
+    if ( fWorker.joinable() ) fWorker.join();
+    fWaitSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    if ( fError ) std::rethrow_exception(fError);
+    return LocalFiles();
+  }
+
+  //--------------------------------------------------
+  void FluxFileStager::Stop()
+  {
+    fStop = true;
+    if ( fWorker.joinable() ) fWorker.join();
+  }
+
+  //--------------------------------------------------
+  std::vector<std::string> FluxFileStager::LocalFiles() const
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::vector<std::string> local;
+    for ( auto const& path : fLocal ) {
+      if ( path != "" ) local.push_back(path);
+    }
+    return local;
+  }
+
+  //--------------------------------------------------
+  FluxFileStager::FetchFunc_t FluxFileStager::CopyToDir(std::string const& dir)
+  {
+    // the counter keeps same-named files from different directories apart
+    auto ncopied = std::make_shared< std::atomic<int> >(0);
+    return [dir,ncopied](std::string const& remote, long) -> std::string {
+      if ( ! evgb::util::MakeDirs(dir) ) {
+        mf::LogWarning("FluxFileStager") << "can't create " << dir;
+        return "";
+      }
+      size_t slash = remote.find_last_of('/');
+      std::string base = ( slash == std::string::npos ) ? remote : remote.substr(slash+1);
+      std::ostringstream local;
+      local << dir << "/evgbflux_" << getpid() << "_" << (*ncopied)++ << "_" << base;
+      std::string tmppath = local.str() + ".tmp";
+
+      {
+        std::ifstream in(remote.c_str(),std::ios::binary);
+        if ( ! in ) return "";
+        std::ofstream out(tmppath.c_str(),std::ios::binary|std::ios::trunc);
+        if ( ! out ) return "";
+        // streaming an empty rdbuf() sets failbit, so don't for 0 bytes
+        if ( in.peek() != std::ifstream::traits_type::eof() ) out << in.rdbuf();
+        out.close();
+        if ( ! out ) {
+          std::remove(tmppath.c_str());
+          return "";
+        }
+      }
+      if ( std::rename(tmppath.c_str(),local.str().c_str()) != 0 ) {
+        std::remove(tmppath.c_str());
+        return "";
+      }
+      mf::LogDebug("FluxFileStager") << "copied " << remote << " to " << local.str();
+      return local.str();
+    };
+  }
+
+} // namespace evgb
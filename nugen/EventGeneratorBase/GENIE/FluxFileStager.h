@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxFileStager.h
+/// \class evgb::FluxFileStager
+/// \brief Make local copies of flux files on a background thread
+///
+///        The files are fetched one at a time, in order, by a user
+///        supplied function (normally a plain copy to a local directory
+///        via CopyToDir()), so the copying overlaps with whatever else
+///        the job does before it needs them (geometry, cross section
+///        tables, ...).  WaitAll() blocks until every file is local and
+///        returns the local paths.
+///
+///        The function runs on the worker thread: it must not use art
+///        services or ifdh, neither of which is safe to call from there.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_FLUXFILESTAGER_H
+#define EVGB_FLUXFILESTAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace evgb {
+
+  class FluxFileStager {
+
+  public:
+
+    /// (file name, size in bytes) as returned by ifdh findMatchingFiles()
+    typedef std::vector< std::pair<std::string,long> > FileList_t;
+
+    /// fetch one file, return its local path ("" on failure)
+    typedef std::function<std::string(std::string const&, long)> FetchFunc_t;
+
+    FluxFileStager(FileList_t const& files, FetchFunc_t fetch);
+    ~FluxFileStager();   ///< stops after the file in progress
+
+    void        Start();
+
+    /// local paths in the original order (failures left out);
+    /// rethrows anything the fetch function threw
+    std::vector<std::string> WaitAll();
+
+    /// stop early; LocalFiles() has whatever made it
+    void        Stop();
+    std::vector<std::string> LocalFiles() const;
+
+    size_t      NFiles()       const { return fFiles.size(); }
+    double      StageSeconds() const { return fStageSeconds; }  ///< start to last file
+    double      WaitSeconds()  const { return fWaitSeconds;  }  ///< blocked in WaitAll()
+
+    /// copy each file into "dir" (created if needed); empty files are
+    /// copied as empty files
+    static FetchFunc_t CopyToDir(std::string const& dir);
+
+  private:
+
+    void Work();
+
+    FileList_t               fFiles;
+    FetchFunc_t              fFetch;
+
+    std::thread              fWorker;
+    mutable std::mutex       fMutex;      ///< guards fLocal and fError
+    std::vector<std::string> fLocal;      ///< local path per file ("" = not (yet) there)
+    std::exception_ptr       fError;
+    std::atomic<bool>        fStop;
+
+    std::chrono::steady_clock::time_point fStart;
+    double                   fStageSeconds;
+    double                   fWaitSeconds;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_FLUXFILESTAGER_H
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxManifest.cxx
+/// \brief Summary of a directory of flux files
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "nugen/EventGeneratorBase/GENIE/FluxManifest.h"
+
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace evgb {
+
+  const char* const FluxManifest::kDefaultName = "evgb_flux_manifest.txt";
+
+  //--------------------------------------------------
+  bool FluxManifestEntry::HasAnyFlavor(std::vector<int> const& pdgs) const
+  {
+    if ( flavors.empty() ) return true;
+    for ( int pdg : pdgs ) {
+      auto itr = flavors.find(pdg);
+      if ( itr != flavors.end() && itr->second > 0 ) return true;
+    }
+    return false;
+  }
+
+  //--------------------------------------------------
+  bool FluxManifest::Read(std::string const& path)
+  {
+    std::ifstream in(path.c_str());
+    if ( ! in ) return false;
+
+    std::string dir;
+    size_t slash = path.find_last_of('/');
+    if ( slash != std::string::npos ) dir = path.substr(0,slash+1);
+
+    std::string line;
+    size_t lineno = 0, nread = 0;
+    while ( std::getline(in,line) ) {
+      ++lineno;
+      if ( line.empty() || line[0] == '#' ) continue;
+      FluxManifestEntry entry;
+      if ( ! ParseLine(line,entry) ) {
+        mf::LogWarning("FluxManifest")
+          << "ignoring bad line " << lineno << " of " << path << ": " << line;
+        continue;
+      }
+      if ( entry.file[0] != '/' ) entry.file = dir + entry.file;
+      fEntries.push_back(entry);
+      ++nread;
+    }
+    mf::LogInfo("FluxManifest") << "read " << nread << " files from " << path;
+    return true;
+  }
+
+  //--------------------------------------------------
+  void FluxManifest::Write(std::ostream& os,
+                           std::vector<FluxManifestEntry> const& entries)
+  {
+    os << "# evgb flux manifest v1\n"
+       << "# file bytes entries pot emin emax pdg:count,pdg:count,...\n";
+    for ( auto const& entry : entries ) {
+      FluxManifestEntry relative = entry;
+      size_t slash = relative.file.find_last_of('/');
+      if ( slash != std::string::npos ) relative.file = relative.file.substr(slash+1);
+      os << FormatLine(relative) << "\n";
+    }
+  }
+
+  //--------------------------------------------------
+  bool FluxManifest::ParseLine(std::string const& line, FluxManifestEntry& entry)
+  {
+    std::istringstream is(line);
+    std::string flavors;
+    if ( ! ( is >> entry.file >> entry.bytes >> entry.entries
+                >> entry.pot >> entry.emin >> entry.emax >> flavors ) ) return false;
+
+    entry.flavors.clear();
+    if ( flavors == "-" ) return true;
+    std::replace(flavors.begin(),flavors.end(),',',' ');
+    std::istringstream fs(flavors);
+    std::string item;
+    while ( fs >> item ) {
+      size_t colon = item.find(':');
+      if ( colon == std::string::npos ) return false;
+      char* end = nullptr;
+      int pdg = std::strtol(item.c_str(),&end,10);
+      if ( end != item.c_str()+colon ) return false;
+      long count = std::strtol(item.c_str()+colon+1,&end,10);
+      if ( *end != '\0' ) return false;
+      entry.flavors[pdg] += count;
+    }
+    return true;
+  }
+
+  //--------------------------------------------------
+  std::string FluxManifest::FormatLine(FluxManifestEntry const& entry)
+  {
+    std::ostringstream os;
+    os.precision(10);
+    os << entry.file << " " << entry.bytes << " " << entry.entries << " "
+       << entry.pot << " " << entry.emin << " " << entry.emax << " ";
+    if ( entry.flavors.empty() ) {
+      os << "-";
+    } else {
+      bool first = true;
+      for ( auto const& flv : entry.flavors ) {
+        os << ( first ? "" : "," ) << flv.first << ":" << flv.second;
+        first = false;
+      }
+    }
+    return os.str();
+  }
+
+} // namespace evgb
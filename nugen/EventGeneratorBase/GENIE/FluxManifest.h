@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  FluxManifest.h
+/// \class evgb::FluxManifest
+/// \brief Summary of a directory of flux files (entries, POT, energy
+///        range and flavor content of each), so that files can be
+///        selected without listing, stat'ing or opening them
+///
+///        The manifest is a text file living next to the flux files
+///        (see the make_flux_manifest tool), one line per file:
+///
+///          # evgb flux manifest v1
+///          # file bytes entries pot emin emax pdg:count,pdg:count,...
+///          g4lbne_00001.dk2nu.root 52428800 250000 5e+16 0.01 119.6 14:231000,-14:15000,12:3800,-12:200
+///
+///        File names are relative to the directory holding the manifest;
+///        a pot of 0 means the tool couldn't tell and a "-" in place of
+///        the flavor list means the flavors weren't counted.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_FLUXMANIFEST_H
+#define EVGB_FLUXMANIFEST_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace evgb {
+
+  struct FluxManifestEntry {
+    std::string         file;        ///< full path once read
+    long int            bytes   = 0;
+    long int            entries = 0;
+    double              pot     = 0; ///< 0 = unknown
+    double              emin    = 0; ///< GeV
+    double              emax    = 0; ///< GeV
+    std::map<int,long>  flavors;     ///< pdg -> # of entries (empty = not counted)
+
+    /// whether any of these flavors is present (true if not counted)
+    bool HasAnyFlavor(std::vector<int> const& pdgs) const;
+  };
+
+  class FluxManifest {
+
+  public:
+
+    static const char* const kDefaultName;   ///< "evgb_flux_manifest.txt"
+
+    /// add the entries of one manifest file; false if it can't be read
+    bool Read(std::string const& path);
+    /// write a manifest; only the base file names are written
+    static void Write(std::ostream& os,
+                      std::vector<FluxManifestEntry> const& entries);
+
+    std::vector<FluxManifestEntry> const& Entries() const { return fEntries; }
+
+    static bool        ParseLine(std::string const& line, FluxManifestEntry& entry);
+    static std::string FormatLine(FluxManifestEntry const& entry);
+
+  private:
+
+    std::vector<FluxManifestEntry> fEntries;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_FLUXMANIFEST_H
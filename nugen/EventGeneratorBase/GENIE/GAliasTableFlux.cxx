@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cmath>
+
+#include <TH1D.h>
+#include <TMath.h>
+
+#include "nugen/EventGeneratorBase/GENIE/GAliasTableFlux.h"
+#include "GENIE/Framework/Numerical/RandomGen.h"
+#include "GENIE/Tools/Flux/GFluxDriverFactory.h"
+#include "GENIE/Framework/Messenger/Messenger.h"
+
+FLUXDRIVERREG4(genie,flux,GAliasTableFlux,genie::flux::GAliasTableFlux)
+
+using namespace genie;
+using namespace genie::flux;
+
+GAliasTableFlux::GAliasTableFlux()
+  : fDirection(0,0,1)
+  , fBeamSpot(0,0,0)
+  , fRt(0)
+  , fTableBuilt(false)
+  , fMaxEv(0)
+  , fgPdgC(0)
+  , fNNeutrinos(0)
+{
+	LOG("Flux", pNOTICE)
+	<< "Instantiating the alias table histogram flux driver";
+}
+
+//________________________________________________________________________________________
+
+GAliasTableFlux::~GAliasTableFlux()
+{
+
+}
+
+//________________________________________________________________________________________
+
+void GAliasTableFlux::AddEnergySpectrum(int nu_pdgc, const TH1D* spectrum)
+{
+	if ( ! spectrum ) {
+		LOG("Flux", pWARN) << "no spectrum given for " << nu_pdgc;
+		return;
+	}
+	if ( ! fPdgCList.ExistsInPDGCodeList(nu_pdgc) ) fPdgCList.push_back(nu_pdgc);
+
+	// densities (per GeV) at the bin centers set the in-bin slope
+	int nbins = spectrum->GetNbinsX();
+	std::vector<double> density(nbins+2,0);
+	for ( int ibin = 1; ibin <= nbins; ++ibin ) {
+		double content = std::max(0.,spectrum->GetBinContent(ibin));
+		density[ibin] = content / spectrum->GetBinWidth(ibin);
+	}
+	// flat towards the ends of the histogram
+	density[0]       = density[1];
+	density[nbins+1] = density[nbins];
+
+	for ( int ibin = 1; ibin <= nbins; ++ibin ) {
+		double content = spectrum->GetBinContent(ibin);
+		if ( content <= 0 ) continue;
+		double left  = 0.5*(density[ibin-1]+density[ibin]);
+		double right = 0.5*(density[ibin]+density[ibin+1]);
+		fCellPdg.push_back(nu_pdgc);
+		fCellLow.push_back(spectrum->GetBinLowEdge(ibin));
+		fCellWidth.push_back(spectrum->GetBinWidth(ibin));
+		fCellSlope.push_back( ( left+right > 0 ) ? (right-left)/(right+left) : 0 );
+		fCellContent.push_back(content);
+	}
+	fTableBuilt = false;
+}
+
+//________________________________________________________________________________________
+
+void GAliasTableFlux::BuildTable(void)
+{
+	// Vose's method: split the cells into those below and above the
+	// mean, then top up each small one from a large one
+	size_t ncells = fCellContent.size();
+	fAliasProb.assign(ncells,1.);
+	fAlias.resize(ncells);
+	for ( size_t i = 0; i < ncells; ++i ) fAlias[i] = i;
+	fMaxEv = 0;
+	if ( ncells == 0 ) {
+		fTableBuilt = true;
+		return;
+	}
+
+	double total = 0;
+	for ( size_t i = 0; i < ncells; ++i ) {
+		total += fCellContent[i];
+		fMaxEv = std::max(fMaxEv,fCellLow[i]+fCellWidth[i]);
+	}
+	std::vector<double> scaled(ncells);
+	std::vector<int> small, large;
+	for ( size_t i = 0; i < ncells; ++i ) {
+		scaled[i] = fCellContent[i] * ncells / total;
+		if ( scaled[i] < 1. ) small.push_back(i);
+		else                  large.push_back(i);
+	}
+	while ( ! small.empty() && ! large.empty() ) {
+		int s = small.back(); small.pop_back();
+		int l = large.back();
+		fAliasProb[s] = scaled[s];
+		fAlias[s]     = l;
+		scaled[l] -= ( 1. - scaled[s] );
+		if ( scaled[l] < 1. ) {
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+	// whatever is left is 1 up to rounding
+	for ( int i : small ) fAliasProb[i] = 1.;
+	for ( int i : large ) fAliasProb[i] = 1.;
+
+	fTableBuilt = true;
+
+	LOG("Flux", pNOTICE)
+	<< "alias table flux: " << fPdgCList.size() << " flavors, "
+	<< ncells << " bins with content, max E " << fMaxEv << " GeV";
+}
+
+//__________________________________________________________________________________________________
+
+const PDGCodeList &GAliasTableFlux::FluxParticles(void)
+{
+	return fPdgCList;
+}
+
+//_________________________________________________________________
+
+double GAliasTableFlux::MaxEnergy(void)
+{
+	if ( ! fTableBuilt ) this->BuildTable();
+	return fMaxEv;
+}
+
+//_________________________________________________________________________
+
+bool GAliasTableFlux::GenerateNext(void)
+{
+	if ( ! fTableBuilt ) this->BuildTable();
+	if ( fCellContent.empty() ) {
+		LOG("Flux", pERROR) << "no flux spectra with content";
+		return false;
+	}
+	TRandom3& rnd = RandomGen::Instance()->RndFlux();
+
+	// cell: one uniform picks the column, the remainder decides alias or not
+	double u = rnd.Rndm() * fAliasProb.size();
+	size_t icell = std::min(size_t(u),fAliasProb.size()-1);
+	if ( u - icell >= fAliasProb[icell] ) icell = fAlias[icell];
+
+	// energy along the line through the bin, density 1 + s(2t-1) on [0,1]
+	double s = fCellSlope[icell];
+	double v = rnd.Rndm();
+	double denom = (1.-s) + std::sqrt((1.-s)*(1.-s) + 4.*s*v);
+	double t = ( denom > 0 ) ? 2.*v/denom : 0.;
+	double Ev = fCellLow[icell] + t * fCellWidth[icell];
+
+	// uniform on the disk, perpendicular to the beam
+	double Rt  = fRt * std::sqrt(rnd.Rndm());
+	double phi = 2.*TMath::Pi() * rnd.Rndm();
+	TVector3 offset(Rt*std::cos(phi),Rt*std::sin(phi),0.);
+	offset.RotateUz(fDirection);
+	TVector3 x = fBeamSpot + offset;
+
+	fgPdgC = fCellPdg[icell];
+	fgP4.SetVect(Ev*fDirection);
+	fgP4.SetE(Ev);
+	fgX4.SetXYZT(x.X(),x.Y(),x.Z(),0.);
+
+	++fNNeutrinos;
+	return true;
+}
+
+//_________________________________________________________________________________________
+
+int GAliasTableFlux::PdgCode(void)
+{
+	return fgPdgC;
+}
+
+//_________________________________________________________________________________________
+
+double GAliasTableFlux::Weight(void)
+{
+	return 1.;
+}
+
+//_________________________________________________________________________________________
+
+const TLorentzVector& GAliasTableFlux::Momentum(void)
+{
+	return fgP4;
+}
+
+//_________________________________________________________________________________________
+
+const TLorentzVector& GAliasTableFlux::Position(void)
+{
+	return fgX4;
+}
+
+//_________________________________________________________________________________________
+
+bool GAliasTableFlux::End(void)
+{
+	return false;
+}
+
+//_________________________________________________________________________________________
+
+long int GAliasTableFlux::Index(void)
+{
+	return -1;
+}
+
+//_________________________________________________________________________________________
+
+void GAliasTableFlux::Clear(Option_t * /* opt */)
+{
+
+}
+
+//_________________________________________________________________________________________
+
+void GAliasTableFlux::GenerateWeighted(bool /* gen_weighted */)
+{
+
+}
+
+//_________________________________________________________________________________________
+
+void GAliasTableFlux::SetNuDirection(const TVector3& direction)
+{
+	fDirection = direction.Unit();
+}
+
+//_________________________________________________________________________________________
+
+void GAliasTableFlux::SetBeamSpot(const TVector3& spot)
+{
+	fBeamSpot = spot;
+}
+
+//_________________________________________________________________________________________
+
+void GAliasTableFlux::SetTransverseRadius(double Rt)
+{
+	fRt = Rt;
+}
+
+//_________________________________________________________________________________________
+
+long int GAliasTableFlux::NFluxNeutrinos(void) const
+{
+	return fNNeutrinos;
+}
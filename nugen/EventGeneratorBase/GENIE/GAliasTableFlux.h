@@ -0,0 +1,91 @@
+//____________________________________________________________________________
+/*!
+
+\class   genie::flux::GAliasTableFlux
+
+\brief   A drop-in for GCylindTH1Flux (histogram and functional fluxes)
+         that samples flavor and energy bin together from a Walker alias
+         table, so a draw costs the same whatever the binning.  Within
+         the chosen bin the energy follows a straight line between the
+         neighbouring bin contents rather than being flat.
+
+         Rays start uniformly on a disk of the transverse radius around
+         the beam spot, perpendicular to the beam direction, as for
+         GCylindTH1Flux.
+
+         Selected in GENIEHelper with FluxAliasTable.
+
+\created October 16, 2026
+
+*/
+//____________________________________________________________________________
+
+#pragma once
+
+#include <vector>
+
+#include <TLorentzVector.h>
+#include <TVector3.h>
+
+#include "GENIE/Framework/EventGen/GFluxI.h"
+#include "GENIE/Framework/ParticleData/PDGCodeList.h"
+
+class TH1D;
+
+namespace genie {
+namespace flux {
+
+class GAliasTableFlux: public GFluxI {
+public:
+	GAliasTableFlux();
+	~GAliasTableFlux();
+
+	// GFluxI
+	const PDGCodeList &FluxParticles(void) override; ///< declare list of flux neutrinos that can be generated (for init. purposes)
+	double MaxEnergy(void) override; ///< declare the max flux neutrino energy that can be generated (for init. purposes)
+	bool GenerateNext(void) override; ///< generate the next flux neutrino (return false in err)
+	int PdgCode(void) override; ///< returns the flux neutrino pdg code
+	double Weight(void) override; ///< returns the flux neutrino weight (always 1)
+	const TLorentzVector& Momentum(void) override; ///< returns the flux neutrino 4-momentum
+	const TLorentzVector& Position(void) override; ///< returns the flux neutrino 4-position (note: expect SI rather than physical units)
+	bool End(void) override; ///< never runs out
+	long int Index(void) override; ///< no meaningful index (-1)
+	void Clear(Option_t *opt) override; ///< nothing to reset
+	void GenerateWeighted(bool gen_weighted) override; ///< rays are always unweighted
+
+	/// bin contents are copied; all the spectra are sampled together,
+	/// in proportion to their contents (as GCylindTH1Flux does)
+	void AddEnergySpectrum(int nu_pdgc, const TH1D* spectrum);
+	void SetNuDirection(const TVector3& direction);
+	void SetBeamSpot(const TVector3& spot);
+	void SetTransverseRadius(double Rt);
+
+	long int NFluxNeutrinos(void) const; ///< neutrinos thrown so far
+
+private:
+	void BuildTable(void); ///< alias table over all (flavor, bin) cells
+
+	PDGCodeList fPdgCList; ///< flavors with a spectrum
+	TVector3 fDirection; ///< unit beam direction
+	TVector3 fBeamSpot; ///< center of the generation disk
+	double fRt; ///< radius of the generation disk
+
+	// one cell per (flavor, energy bin), only the ones with content
+	std::vector<int> fCellPdg; ///< flavor of the cell
+	std::vector<double> fCellLow; ///< lower bin edge (GeV)
+	std::vector<double> fCellWidth; ///< bin width (GeV)
+	std::vector<double> fCellSlope; ///< (right-left)/(right+left) edge density, for the in-bin line
+	std::vector<double> fCellContent; ///< bin content (table input)
+	std::vector<double> fAliasProb; ///< probability of keeping the cell
+	std::vector<int> fAlias; ///< cell used otherwise
+	bool fTableBuilt; ///< rebuilt after every AddEnergySpectrum()
+	double fMaxEv; ///< top edge of the highest cell
+
+	int fgPdgC; ///< current generated nu pdg-code
+	TLorentzVector fgP4; ///< current generated nu 4-momentum
+	TLorentzVector fgX4; ///< current generated nu 4-position
+	long int fNNeutrinos; ///< number of flux neutrinos thrown so far
+};
+
+} // flux namespace
+} // genie namespace
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#include <TMath.h>
+#include <TString.h>
+
+#include "nugen/EventGeneratorBase/GENIE/GColumnarFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/ColumnarFluxFile.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+#include "GENIE/Framework/Numerical/RandomGen.h"
+#include "GENIE/Tools/Flux/GFluxDriverFactory.h"
+#include "GENIE/Framework/Messenger/Messenger.h"
+#include "GENIE/Framework/Utils/XmlParserUtils.h"
+
+FLUXDRIVERREG4(genie,flux,GColumnarFlux,genie::flux::GColumnarFlux)
+
+using namespace genie;
+using namespace genie::flux;
+
+typedef evgb::ColumnarFluxFile CFF;
+
+GColumnarFlux::GColumnarFlux()
+  : GFluxFileConfigI()
+  , GFluxExposureI(genie::flux::kPOTs)
+  , fMaxEv(0)
+  , fMaxWeight(0)
+  , fGenWeighted(false)
+  , fIFile(0)
+  , fIRay(-1)
+  , fEnd(false)
+  , fNRaysThisCycle(0)
+  , fgPdgC(0)
+  , fWeight(0)
+  , fDist(0)
+  , fAccumPOTs(0)
+  , fNNeutrinos(0)
+{
+	LOG("Flux", pNOTICE)
+	<< "Instantiating the columnar flux driver";
+}
+
+//________________________________________________________________________________________
+
+GColumnarFlux::~GColumnarFlux()
+{
+	this->CleanUp();
+}
+
+//________________________________________________________________________________________
+
+void GColumnarFlux::CleanUp(void)
+{
+	for ( auto file : fFiles ) delete file;
+	fFiles.clear();
+	fPOTsPerRay.clear();
+	fFirstRay.clear();
+}
+
+//________________________________________________________________________________________
+
+void GColumnarFlux::LoadBeamSimData(const std::vector<std::string>& filenames,
+                                    const std::string& det_loc)
+{
+	this->CleanUp();
+	fMaxEv = 0;
+	fMaxWeight = 0;
+	long int nrays = 0;
+	double pots = 0;
+
+	for ( auto const& fname : filenames ) {
+		CFF* file = new CFF;
+		if ( ! file->Open(fname) || file->NRays() == 0 ) {
+			LOG("Flux", pWARN) << "skipping unusable columnar flux file " << fname;
+			delete file;
+			continue;
+		}
+		fFiles.push_back(file);
+		fFirstRay.push_back(nrays);
+		fPOTsPerRay.push_back(file->POT()/file->NRays());
+		nrays += file->NRays();
+		pots  += file->POT();
+		fMaxEv     = std::max(fMaxEv,(double)file->EMax());
+		fMaxWeight = std::max(fMaxWeight,(double)file->WMax());
+		if ( file->POT() <= 0 ) {
+			LOG("Flux", pWARN) << fname << " has no POT; exposure will be underestimated";
+		}
+	}
+	if ( fFiles.empty() ) {
+		LOG("Flux", pFATAL) << "no usable columnar flux files (det_loc \"" << det_loc << "\")";
+		exit(1);
+	}
+	if ( fMaxWeight <= 0 ) fMaxWeight = 1;
+
+	// unless told otherwise, generate whatever the files hold
+	if ( fPdgCList->size() == 0 ) {
+		for ( auto file : fFiles ) {
+			for ( int pdg : file->Flavors() ) {
+				if ( ! fPdgCList->ExistsInPDGCodeList(pdg) ) fPdgCList->push_back(pdg);
+			}
+		}
+	}
+
+	// start somewhere random so that jobs with the same files differ
+	long int start = RandomGen::Instance()->RndFlux().Integer(nrays);
+	fIFile = std::upper_bound(fFirstRay.begin(),fFirstRay.end(),start) - fFirstRay.begin() - 1;
+	fIRay  = start - fFirstRay[fIFile] - 1;
+	fEnd   = false;
+	fNRaysThisCycle = 0;
+
+	LOG("Flux", pNOTICE)
+	<< "columnar flux: " << fFiles.size() << " files, " << nrays << " rays, "
+	<< pots << " POT, max E " << fMaxEv << " GeV, max weight " << fMaxWeight;
+}
+
+//__________________________________________________________________________________________________
+
+void GColumnarFlux::PrintConfig(void)
+{
+	std::ostringstream s;
+	s << "GColumnarFlux config:"
+	  << "\n  weighted: " << ( fGenWeighted ? "yes" : "no" )
+	  << ", max E " << fMaxEv << " GeV, max weight " << fMaxWeight
+	  << "\n  upstream z: " << fZ0 << ", cycles: " << fNCycles
+	  << "\n  flavors:";
+	for ( auto pdg : *fPdgCList ) s << " " << pdg;
+	for ( size_t i = 0; i < fFiles.size(); ++i ) {
+	  s << "\n  [" << i << "] " << fFiles[i]->NRays() << " rays, "
+	    << fFiles[i]->POT() << " POT" << ( fFiles[i]->HasParentage() ? ", parentage " : " " )
+	    << fFiles[i]->Path();
+	}
+	LOG("Flux", pNOTICE) << s.str();
+}
+
+//__________________________________________________________________________________________________
+
+const PDGCodeList &GColumnarFlux::FluxParticles(void)
+{
+	return *fPdgCList;
+}
+
+//_________________________________________________________________
+
+double GColumnarFlux::MaxEnergy(void)
+{
+	return fMaxEv;
+}
+
+//_________________________________________________________________________
+
+bool GColumnarFlux::NextRay(void)
+{
+	while ( ! fEnd ) {
+		if ( ++fIRay >= (long int)fFiles[fIFile]->NRays() ) {
+			fIRay = 0;
+			if ( ++fIFile >= fFiles.size() ) {
+				fIFile = 0;
+				++fICycle;
+				if ( fNCycles > 0 && fICycle >= fNCycles ) {
+					fEnd = true;
+					break;
+				}
+				if ( fNRaysThisCycle == 0 && fICycle > 1 ) {
+					LOG("Flux", pERROR) << "no rays of the requested flavors in a full cycle";
+					fEnd = true;
+					break;
+				}
+				fNRaysThisCycle = 0;
+			}
+		}
+		// every ray looked at counts towards the exposure
+		fAccumPOTs += fPOTsPerRay[fIFile] / ( fGenWeighted ? 1. : fMaxWeight );
+
+		int pdg = TMath::Nint(fFiles[fIFile]->Col(CFF::kPdg)[fIRay]);
+		if ( fPdgCList->size() > 0 && ! fPdgCList->ExistsInPDGCodeList(pdg) ) continue;
+		++fNRaysThisCycle;
+		return true;
+	}
+	return false;
+}
+
+//_________________________________________________________________________
+
+bool GColumnarFlux::GenerateNext(void)
+{
+	RandomGen * rnd = RandomGen::Instance();
+
+	while ( true ) {
+		if ( ! this->NextRay() ) return false;
+		double wgt = this->RayWeight();
+		if ( fGenWeighted ) {
+			fWeight = wgt;
+			break;
+		}
+		// accept/reject on the weight; any excess over the max stays a weight
+		if ( rnd->RndFlux().Rndm()*fMaxWeight < wgt ) {
+			fWeight = std::max(1.,wgt/fMaxWeight);
+			break;
+		}
+	}
+
+	CFF const& file = *fFiles[fIFile];
+	fgPdgC = TMath::Nint(file.Col(CFF::kPdg)[fIRay]);
+	double px = file.Col(CFF::kPx)[fIRay];
+	double py = file.Col(CFF::kPy)[fIRay];
+	double pz = file.Col(CFF::kPz)[fIRay];
+	double x  = file.Col(CFF::kX)[fIRay];
+	double y  = file.Col(CFF::kY)[fIRay];
+	double z  = file.Col(CFF::kZ)[fIRay];
+	fDist     = file.Col(CFF::kDist)[fIRay];
+	fgP4.SetPxPyPzE(px,py,pz,file.Col(CFF::kE)[fIRay]);
+
+	// move the ray back (or forward) to the requested upstream z
+	if ( TMath::Abs(fZ0) < 1.0e30 && pz != 0 ) {
+		double scale = ( fZ0 - z ) / pz;
+		x += px * scale;
+		y += py * scale;
+		z  = fZ0;
+		fDist += scale * fgP4.P();
+	}
+	fgX4.SetXYZT(x,y,z,0.);
+
+	++fNNeutrinos;
+	return true;
+}
+
+//_________________________________________________________________________________________
+
+int GColumnarFlux::PdgCode(void)
+{
+	return fgPdgC;
+}
+
+//_________________________________________________________________________________________
+
+double GColumnarFlux::Weight(void)
+{
+	return fWeight;
+}
+
+//_________________________________________________________________________________________
+
+const TLorentzVector& GColumnarFlux::Momentum(void)
+{
+	return fgP4;
+}
+
+//_________________________________________________________________________________________
+
+const TLorentzVector& GColumnarFlux::Position(void)
+{
+	return fgX4;
+}
+
+//_________________________________________________________________________________________
+
+bool GColumnarFlux::End(void)
+{
+	return fEnd;
+}
+
+//_________________________________________________________________________________________
+
+long int GColumnarFlux::Index(void)
+{
+	if ( fFiles.empty() || fIRay < 0 ) return -1;
+	return fFirstRay[fIFile] + fIRay;
+}
+
+//_________________________________________________________________________________________
+
+void GColumnarFlux::Clear(Option_t *opt)
+{
+	// GENIE's driver calls this after the max interaction probability scan
+	if ( TString(opt).Contains("CycleHistory") ) {
+		fICycle = 0;
+		fNRaysThisCycle = 0;
+		fAccumPOTs = 0;
+		fNNeutrinos = 0;
+	}
+}
+
+//_________________________________________________________________________________________
+
+void GColumnarFlux::GenerateWeighted(bool gen_weighted)
+{
+	fGenWeighted = gen_weighted;
+}
+
+//_________________________________________________________________________________________
+
+double GColumnarFlux::GetTotalExposure(void) const
+{
+	return fAccumPOTs;
+}
+
+//_________________________________________________________________________________________
+
+long int GColumnarFlux::NFluxNeutrinos(void) const
+{
+	return fNNeutrinos;
+}
+
+//_________________________________________________________________________________________
+
+const evgb::ColumnarFluxFile* GColumnarFlux::CurrentFile(void) const
+{
+	return ( fFiles.empty() ) ? nullptr : fFiles[fIFile];
+}
+
+//_________________________________________________________________________________________
+
+long int GColumnarFlux::CurrentRay(void) const
+{
+	return fIRay;
+}
+
+//_________________________________________________________________________________________
+
+double GColumnarFlux::RayWeight(void) const
+{
+	return fFiles[fIFile]->Col(CFF::kWgt)[fIRay];
+}
+
+//_________________________________________________________________________________________
+
+double GColumnarFlux::DecayDist(void) const
+{
+	return fDist;
+}
+
+//_________________________________________________________________________________________
+
+std::string GColumnarFlux::ProjectionKey(const std::string& det_loc,
+                                         const std::string& xmlbase)
+{
+	// the window & beam coordinates come from det_loc's entry in the XML
+	uint64_t hash = evgb::util::HashString(det_loc);
+	uint64_t xmlhash = 0;
+	std::string xmlpath = genie::utils::xml::GetXMLFilePath(xmlbase);
+	if ( evgb::util::HashFile(xmlpath,xmlhash) ) {
+		hash = evgb::util::HashBytes(&xmlhash,sizeof(xmlhash),hash);
+	} else {
+		LOG("Flux", pWARN) << "can't read " << xmlbase << "; projection key uses only its name";
+		hash = evgb::util::HashString(xmlbase,hash);
+	}
+	std::string key = det_loc;
+	for ( auto& c : key ) {
+		if ( ! isalnum((unsigned char)c) ) c = '_';
+	}
+	return key + "-" + evgb::util::HashToHex(hash).substr(0,8);
+}
+
+//_________________________________________________________________________________________
+
+std::string GColumnarFlux::ProjectedFileName(const std::string& dir,
+                                             const std::string& srcfile,
+                                             const std::string& key)
+{
+	size_t slash = srcfile.find_last_of('/');
+	std::string base = ( slash == std::string::npos ) ? srcfile : srcfile.substr(slash+1);
+	size_t ext = base.rfind(".root");
+	if ( ext != std::string::npos && ext + 5 == base.size() ) base.erase(ext);
+	return dir + "/" + base + "." + key + ".cflux";
+}
@@ -92,6 +92,11 @@
 #include "dk2nu/tree/dkmeta.h"
 #include "dk2nu/genie/GDk2NuFlux.h"
 
+#include "nugen/EventGeneratorBase/GENIE/GColumnarFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/ColumnarFluxFile.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxReadAhead.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxEnergyWindow.h"
+
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "cetlib_except/exception.h"
 
@@ -809,6 +814,19 @@ void evgb::FillMCFlux(genie::GFluxI* fdriver, simb::MCFlux& mcflux)
     fdriver = gblender->GetFluxGenerator();
   }
 
+  // reading ahead? then the real driver is already past this ray
+  evgb::GFluxReadAhead* greadahead =
+    dynamic_cast<evgb::GFluxReadAhead *>(fdriver);
+  if ( greadahead ) {
+    mcflux = greadahead->CurrentMCFlux();
+    return;
+  }
+
+  // an energy window passes on the real driver's current ray
+  evgb::GFluxEnergyWindow* gwindow =
+    dynamic_cast<evgb::GFluxEnergyWindow *>(fdriver);
+  if ( gwindow ) fdriver = gwindow->GetFluxGenerator();
+
   genie::flux::GNuMIFlux* gnumi =
     dynamic_cast<genie::flux::GNuMIFlux *>(fdriver);
   if ( gnumi ) {
@@ -826,6 +844,12 @@ void evgb::FillMCFlux(genie::GFluxI* fdriver, simb::MCFlux& mcflux)
       if ( gdk2nu ) {
         FillMCFlux(gdk2nu,mcflux);
         return;
+      }
+      genie::flux::GColumnarFlux* gcolumnar =
+        dynamic_cast<genie::flux::GColumnarFlux *>(fdriver);
+      if ( gcolumnar ) {
+        FillMCFlux(gcolumnar,mcflux);
+        return;
       } else {
         static bool first = true;
         if ( first ) {
@@ -1285,4 +1309,51 @@ void evgb::FillMCFlux(const bsim::Dk2Nu* dk2nu,
 
 //---------------------------------------------------------------------------
 
+//---------------------------------------------------------------------------
+void evgb::FillMCFlux(genie::flux::GColumnarFlux* gcolumnar,
+                      simb::MCFlux& flux)
+{
+  // columnar files are reduced gsimple/dk2nu rays; fill what they keep
+  flux.Reset();
 
+  const evgb::ColumnarFluxFile* cfile = gcolumnar->CurrentFile();
+  // label the rays by the driver that made them (files without it: gsimple)
+  int srctype = ( cfile ) ? cfile->FluxType() : 0;
+  flux.fFluxType = ( srctype != 0 ) ? simb::Flux_t(srctype) : simb::kSimple_Flux;
+
+  flux.fntype    = gcolumnar->PdgCode();
+  flux.fnimpwt   = gcolumnar->RayWeight();
+  flux.fdk2gen   = gcolumnar->DecayDist();
+  flux.fnenergyn = flux.fnenergyf = gcolumnar->Momentum().E();
+
+  if ( ! cfile || ! cfile->HasParentage() ) return;
+
+  typedef evgb::ColumnarFluxFile CFF;
+  long int iray = gcolumnar->CurrentRay();
+  auto col = [cfile,iray](CFF::Column_t c) -> double {
+    const float* data = cfile->Col(c);
+    return ( data ) ? data[iray] : 0;
+  };
+
+  flux.fptype    = TMath::Nint(col(CFF::kPtype));
+  flux.fndecay   = TMath::Nint(col(CFF::kNdecay));
+  flux.fppmedium = TMath::Nint(col(CFF::kPpmedium));
+  flux.ftptype   = TMath::Nint(col(CFF::kTptype));
+
+  flux.fvx       = col(CFF::kVx);
+  flux.fvy       = col(CFF::kVy);
+  flux.fvz       = col(CFF::kVz);
+  flux.fpdpx     = col(CFF::kPdpx);
+  flux.fpdpy     = col(CFF::kPdpy);
+  flux.fpdpz     = col(CFF::kPdpz);
+
+  double apppz = col(CFF::kPppz);
+  if ( TMath::Abs(apppz) < 1.0e-30 ) apppz = 1.0e-30;
+  flux.fppdxdz   = col(CFF::kPppx) / apppz;
+  flux.fppdydz   = col(CFF::kPppy) / apppz;
+  flux.fpppz     = col(CFF::kPppz);
+
+  flux.ftpx      = col(CFF::kTpx);
+  flux.ftpy      = col(CFF::kTpy);
+  flux.ftpz      = col(CFF::kTpz);
+}
@@ -26,6 +26,7 @@ namespace genie {
     class GSimpleNtpAux;
     class GSimpleNtpMeta;
     class GDk2NuFlux;
+    class GColumnarFlux;
   }
 }
 namespace bsim {
@@ -100,6 +101,9 @@ namespace evgb {
                   const bsim::NuChoice* nuchoice,
                   simb::MCFlux& flux);
 
+  void FillMCFlux(genie::flux::GColumnarFlux* gcolumnar,
+                  simb::MCFlux& mcflux);
+
 } // end-of-namespace evgb
 
 #endif  // EVGB_GENIE2ART_H
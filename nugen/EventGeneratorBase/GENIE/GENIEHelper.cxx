@@ -12,11 +12,15 @@
 #include <math.h>
 #include <map>
 #include <fstream>
+#include <chrono>
 #include <iomanip>
 #include <algorithm>
 #include <sstream>
-#include <glob.h>
+#include <fnmatch.h>
 #include <cstdlib>  // for unsetenv()
+#include <cstdio>   // for remove()
+#include <unistd.h> // for getpid(), rmdir()
+#include <pwd.h>    // for getpwnam()
 
 //ROOT includes
 #include "TH1.h"
@@ -34,6 +38,10 @@
 #include "TMath.h"
 #include "TStopwatch.h"
 #include "TRotation.h"
+#include "TROOT.h"   // ROOT::EnableThreadSafety
+#include "TGeoManager.h"
+#include "TGeoVolume.h"
+#include "TGeoBBox.h"
 
 //GENIE includes
 #ifdef GENIE_PRE_R3
@@ -157,6 +165,16 @@
 #include "nugen/EventGeneratorBase/GENIE/EvtTimeShiftI.h"
 
 #include "nugen/EventGeneratorBase/GENIE/GPowerSpectrumAtmoFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/GAliasTableFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/GColumnarFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxReadAhead.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxEnergyWindow.h"
+#include "nugen/EventGeneratorBase/GENIE/XSecSplineCache.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+#include "nugen/EventGeneratorBase/GENIE/GeomMaxPathScanner.h"
+#include "nugen/EventGeneratorBase/GENIE/FluxFileStager.h"
+#include "nugen/EventGeneratorBase/GENIE/FluxManifest.h"
+#include "nugen/EventGeneratorBase/GENIE/FluxFileLister.h"
 
 // nusimdata includes
 #include "nusimdata/SimulationBase/MCTruth.h"
@@ -210,6 +228,35 @@ namespace evgb {
   static const int kNuTau    = 4;
   static const int kNuTauBar = 5;
 
+  // leading "~" or "~user", as glob(GLOB_TILDE) would expand it
+  static std::string ExpandTilde(std::string const& path)
+  {
+    if ( path.empty() || path[0] != '~' ) return path;
+    size_t slash = path.find('/');
+    std::string user = path.substr(1,slash-1);
+    const char* home = 0;
+    if ( user == "" ) {
+      home = std::getenv("HOME");
+      if ( ! home ) {
+        struct passwd* pw = getpwuid(getuid());
+        if ( pw ) home = pw->pw_dir;
+      }
+    } else {
+      struct passwd* pw = getpwnam(user.c_str());
+      if ( pw ) home = pw->pw_dir;
+    }
+    if ( ! home ) return path;
+    return std::string(home) + ( ( slash == std::string::npos ) ? "" : path.substr(slash) );
+  }
+
+  // (scramble seed, offset) of the quasi-random atmo fluxes alive in
+  // this process; two with the same pair would replay the same points
+  static std::set< std::pair<int,int> >& QuasiRandomClaims()
+  {
+    static std::set< std::pair<int,int> > claims;
+    return claims;
+  }
+
   //--------------------------------------------------
   GENIEHelper::GENIEHelper(fhicl::ParameterSet const& pset,
                            TGeoManager*               geoManager,
@@ -222,6 +269,12 @@ namespace evgb {
     , fFluxD             (0)
     , fFluxD2GMCJD       (0)
     , fDriver            (0)
+    , fTopVol            (0)
+    , fWorldVol          (0)
+    , fFluxExposureI     (0)
+    , fFluxBlender       (0)
+    , fFluxReadAheadD    (0)
+    , fFluxWindowD       (0)
     , fIFDH              (0)
     , fHelperRandom      (0)
     , fUseHelperRndGen4GENIE(pset.get< bool                  >("UseHelperRndGen4GENIE",true))
@@ -233,6 +286,18 @@ namespace evgb {
     , fMaxFluxFileNumber (pset.get< int                      >("MaxFluxFileNumber",9999) ) // at most 9999 files
     , fFluxCopyMethod    (pset.get< std::string              >("FluxCopyMethod","DIRECT")) // "DIRECT" = old direct access method
     , fFluxCleanup       (pset.get< std::string              >("FluxCleanup","/var/tmp") ) // "ALWAYS", "NEVER", "/var/tmp"
+    , fFluxStageAsync    (pset.get< bool                     >("FluxStageAsync",   false) )
+    , fFluxStageDir      (pset.get< std::string              >("FluxStageDir", "/var/tmp") )
+    , fFluxStager        (0)
+    , fFluxOwnCopies     (false)
+    , fFluxManifest      (pset.get< std::string              >("FluxManifest",     "")    )
+    , fTargetPOT         (pset.get< double                   >("TargetPOT",        0.0)   )
+    , fFluxGlobThreads   (pset.get< int                      >("FluxGlobThreads",  1)     )
+    , fFluxGlobCacheDir  (pset.get< std::string              >("FluxGlobCacheDir", "")    )
+    , fFluxGlobCacheTTL  (pset.get< double                   >("FluxGlobCacheTTL", 600.)  )
+    , fProjectedFluxDir  (pset.get< std::string              >("ProjectedFluxDir", "")    )
+    , fFluxReadAhead     (pset.get< int                      >("FluxReadAhead",    0)     )
+    , fFluxEnergyWindow  (pset.get< std::vector<double>      >("FluxEnergyWindow", {})    )
     , fBeamName          (pset.get< std::string              >("BeamName")               )
     , fFluxRotCfg        (pset.get< std::string              >("FluxRotCfg","none")      )
     , fFluxRotValues     (pset.get< std::vector<double>      >("FluxRotValues", {} )     ) // default empty vector
@@ -241,6 +306,7 @@ namespace evgb {
     , fWorldVolume       ("volWorld")
     , fDetLocation       (pset.get< std::string              >("DetectorLocation")       )
     , fFluxUpstreamZ     (pset.get< double                   >("FluxUpstreamZ",  -2.e30) )
+    , fFluxEntryReuse    (pset.get< int                      >("FluxEntryReuse",      1) )
     , fEventsPerSpill    (pset.get< double                   >("EventsPerSpill",      0) )
     , fPOTPerSpill       (pset.get< double                   >("POTPerSpill",     0.0) )
     , fHistEventsPerSpill(0.)
@@ -250,6 +316,7 @@ namespace evgb {
     , fMonoEnergy        (pset.get< double                   >("MonoEnergy",        2.0) )
     , fFunctionalFlux    (pset.get< std::string              >("FunctionalFlux", "x") )
     , fFunctionalBinning (pset.get< int                      >("FunctionalBinning", 10000) )
+    , fFluxAliasTable    (pset.get< bool                     >("FluxAliasTable",  false) )
     , fEmin              (pset.get< double                   >("FluxEmin", 0) )
     , fEmax              (pset.get< double                   >("FluxEmax", 10) )
     , fBeamRadius        (pset.get< double                   >("BeamRadius",        3.0) )
@@ -260,14 +327,24 @@ namespace evgb {
     , fSpillTimeConfig   (pset.get< std::string              >("SpillTimeConfig",    "") )
     , fAddGenieVtxTime   (pset.get< bool                     >("AddGenieVtxTime", false) )
     , fForceApplyFlxWgt  (pset.get< bool                     >("ForceApplyFlxWgt", true) )
+    , fForceInteraction  (pset.get< bool                     >("ForceInteraction", false) )
     , fGenFlavors        (pset.get< std::vector<int>         >("GenFlavors")             )
     , fAtmoEmin          (pset.get< double                   >("AtmoEmin",          0.1) )
     , fAtmoEmax          (pset.get< double                   >("AtmoEmax",         10.0) )
     , fAtmoRl            (pset.get< double                   >("Rl",               20.0) )
     , fAtmoRt            (pset.get< double                   >("Rt",               20.0) )
     , fAtmoSpectralIndex (pset.get< double                   >("SpectralIndex",     2.0) )
+    , fAtmoImportance    (pset.get< bool                     >("AtmoImportanceSampling", false) )
+    , fAtmoQuasiRandom   (pset.get< bool                     >("AtmoQuasiRandom",  false) )
+    , fAtmoQuasiOffset   (pset.get< int                      >("AtmoQuasiRandomOffset",  0) )
+    , fAtmoQuasiScramble (pset.get< int                      >("AtmoQuasiRandomScramble", 0) )
+    , fAtmoQuasiClaimed  (false)
+    , fAtmoAutoRadii     (pset.get< bool                     >("AtmoAutoRadii",    false) )
+    , fAtmoRadiusMargin  (pset.get< double                   >("AtmoRadiusMargin",   0.0) )
     , fEnvironment       (pset.get< std::vector<std::string> >("Environment")            )
     , fXSecTable         (pset.get< std::string              >("XSecTable",          "") ) //e.g. "gxspl-FNALsmall.xml"
+    , fXSecCacheDir      (pset.get< std::string              >("XSecCacheDir",       "") ) // "" = no cache
+    , fXSecFilterSplines (pset.get< bool                     >("XSecFilterSplines", false) )
     , fTuneName          (pset.get< std::string              >("TuneName","${GENIE_XSEC_TUNE}") )
     , fEventGeneratorList(pset.get< std::string              >("EventGeneratorList", "Default") )
     , fGXMLPATH          (pset.get< std::string              >("GXMLPATH",           "") )
@@ -279,7 +356,12 @@ namespace evgb {
     , fUseBlenderDist    (pset.get< bool                     >("UseBlenderDist",     true) )
     , fFiducialCut       (pset.get< std::string              >("FiducialCut",    "none") )
     , fGeomScan          (pset.get< std::string              >("GeomScan",    "default") )
+    , fMaxPathCacheDir   (pset.get< std::string              >("MaxPathCacheDir",    "") ) // "" = no cache
+    , fGeomScanThreads   (pset.get< int                      >("GeomScanThreads",     0) ) // 0 = GENIE's own scan
+    , fScannedMaxPath    (0)
     , fDebugFlags        (pset.get< unsigned int             >("DebugFlags",          0) )
+    , fStatsFile         (pset.get< std::string              >("StatsFile",          "") )
+    , fLastFluxRun       (kNoFluxRun)
   {
 
     // fEnvironment is (generally) deprecated ... print out any settings
@@ -357,8 +439,12 @@ namespace evgb {
     if ( fFluxType.find("tree_") == 0 ) SqueezeFilePatterns();
 
     ExpandFluxPaths();
-    if ( fFluxCopyMethod == "DIRECT" ) ExpandFluxFilePatternsDirect();
-    else                               ExpandFluxFilePatternsIFDH();
+    if      ( fFluxCopyMethod == "DIRECT" ) ExpandFluxFilePatternsDirect();
+    else if ( fFluxCopyMethod == "COPY"   ) ExpandFluxFilePatternsCopy();
+    else                                    ExpandFluxFilePatternsIFDH();
+    // only tree_ fluxes leave opening their files to InitializeFluxDriver(),
+    // everything else needs them now
+    if ( fFluxType.find("tree_") != 0 ) FinishFluxStaging();
 
     /// For atmos_ / astro_ fluxes we might need to set a
     /// coordinate system rotation
@@ -424,12 +510,17 @@ namespace evgb {
         << fAtmoEmax << " GeV."
         << '\n'
         << "  Generation surface of: (" << fAtmoRl << ","
-        << fAtmoRt << ")";
+        << fAtmoRt << ")"
+        << ( fAtmoAutoRadii ? " (to be fit to the TopVolume)" : "" )
+        << ( fAtmoImportance ? "\n  Importance sampling from the flux tables" : "" )
+        << ( fAtmoQuasiRandom ? "\n  Quasi-random (Sobol) sampling" : "" );
     }  else {
 
       // flux methods other than "mono" and "function" require files
       std::string fileliststr;
-      if ( fSelectedFluxFiles.empty() ) {
+      if ( fFluxStager ) {
+        fileliststr = Form("(%zu files still being staged)",fFluxStager->NFiles());
+      } else if ( fSelectedFluxFiles.empty() ) {
         fileliststr = "NO FLUX FILES FOUND!";
         mf::LogWarning("GENIEHelper")  << fileliststr;
       }
@@ -487,29 +578,16 @@ namespace evgb {
   //--------------------------------------------------
   GENIEHelper::~GENIEHelper()
   {
+    if ( fAtmoQuasiClaimed ) {
+      QuasiRandomClaims().erase(std::make_pair(fAtmoQuasiScramble,fAtmoQuasiOffset));
+    }
+
     // user request writing out the scan of the geometry
     if ( fGeomD && fMaxPathOutInfo != "" ) {
-      genie::geometry::ROOTGeomAnalyzer* rgeom =
-        dynamic_cast<genie::geometry::ROOTGeomAnalyzer*>(fGeomD);
-
       string filename = "maxpathlength.xml";
       mf::LogInfo("GENIEHelper")
         << "Saving MaxPathLengths as: \"" << filename << "\"";
-
-      const genie::PathLengthList& maxpath = rgeom->GetMaxPathLengths();
-
-      maxpath.SaveAsXml(filename);
-      // append extra info to file
-      std::ofstream mpfile(filename.c_str(), std::ios_base::app);
-      mpfile
-        << std::endl
-        << "<!-- this file is only relevant for a setup compatible with:"
-        << std::endl
-        << fMaxPathOutInfo
-        << std::endl
-        << "-->"
-        << std::endl;
-      mpfile.close();
+      WriteMaxPathLengths(filename,fMaxPathOutInfo);
     }  // finished writing max path length XML file (if requested)
 
     // protect against lack of driver due to not getting to Initialize()
@@ -521,7 +599,19 @@ namespace evgb {
         << ( (fFluxD)  ? "":" genie::GFluxI" );
     } else {
 
-      double probscale = fDriver->GlobProbScale();
+      // the worker is done; the exposure is that of the last ray used
+      if ( fFluxReadAheadD ) {
+        fFluxReadAheadD->StopReading();
+        mf::LogInfo("GENIEHelper")
+          << "FluxReadAhead " << fFluxReadAheadD->NRaysAhead()
+          << " rays: waited " << fFluxReadAheadD->WaitSeconds() << " s for the reader";
+      }
+      if ( fFluxWindowD ) {
+        mf::LogInfo("GENIEHelper")
+          << "FluxEnergyWindow dropped " << fFluxWindowD->NRejected() << " rays";
+      }
+
+      double probscale = ExposureProbScale();
       double rawpots   = 0;
 
       // rather than ask individual flux drivers for info
@@ -532,23 +622,63 @@ namespace evgb {
       if ( fexposure ) {
         rawpots = fexposure->GetTotalExposure();
       }
+      genie::GFluxI* realFluxD = fFluxD;
+      if ( fFluxReadAheadD ) realFluxD = fFluxReadAheadD->GetFluxGenerator();
+      if ( fFluxWindowD    ) realFluxD = fFluxWindowD->GetFluxGenerator();
       genie::flux::GFluxFileConfigI* ffileconfig =
-        dynamic_cast<genie::flux::GFluxFileConfigI*>(fFluxD);
+        dynamic_cast<genie::flux::GFluxFileConfigI*>(realFluxD);
       if ( ffileconfig ) {
         ffileconfig->PrintConfig();
       }
 
       mf::LogInfo("GENIEHelper")
         << " Total Exposure " << fTotalExposure
-        << " GMCJDriver GlobProbScale " << probscale
+        << " GMCJDriver GlobProbScale " << fDriver->GlobProbScale()
+        << ( ( fForceInteraction ) ? " (not used, forced interactions)" : "" )
         << " FluxDriver base pots " << rawpots
         << " corrected POTS " << rawpots/TMath::Max(probscale,1.0e-100);
+
+      // per-stage timing & counters
+      std::ostringstream statsjson;
+      Stats().WriteJSON(statsjson,fFluxType);
+      mf::LogInfo("GENIEHelper") << "GENIEHelper stats:\n" << statsjson.str();
+      if ( fStatsFile != "" ) {
+        std::ofstream statsfile(fStatsFile.c_str());
+        if ( statsfile ) statsfile << statsjson.str();
+        else mf::LogWarning("GENIEHelper")
+               << "could not write StatsFile \"" << fStatsFile << "\"";
+      }
     }
 
     // clean up owned genie object (other genie obj are ref ptrs)
     delete fGenieEventRecord;
     delete fDriver;
     delete fHelperRandom;
+    delete fScannedMaxPath;
+
+    // anything staged by a job that never got going still gets cleaned up
+    if ( fFluxStager ) {
+      fFluxStager->Stop();
+      std::vector<std::string> staged = fFluxStager->LocalFiles();
+      fSelectedFluxFiles.insert(fSelectedFluxFiles.end(),staged.begin(),staged.end());
+      delete fFluxStager;
+      fFluxStager = 0;
+    }
+
+    // our own copies (FluxCopyMethod "COPY", or IFDH staged in the background)
+    if ( fFluxOwnCopies ) {
+      auto ffitr = fSelectedFluxFiles.begin();
+      for ( ; ffitr != fSelectedFluxFiles.end(); ++ffitr ) {
+        std::string ff = *ffitr;
+        if ( fFluxCleanup.find("ALWAYS") == 0 ||
+             ( fFluxCleanup.find("/var/tmp") == 0 && ff.find("/var/tmp") == 0 ) ) {
+          mf::LogDebug("GENIEHelper") << "delete " << ff;
+          std::remove(ff.c_str());
+        }
+      }
+      // nothing left for ifdh to remove
+      fSelectedFluxFiles.clear();
+    }
 
 #ifndef NO_IFDH_LIB
   #ifdef USE_IFDH_SERVICE
@@ -587,6 +717,67 @@ namespace evgb {
 
   }
 
+  //--------------------------------------------------
+  bool GENIEHelper::SplineSelection(std::set<int>& targets, std::set<int>& probes) const
+  {
+    genie::geometry::ROOTGeomAnalyzer* rgeom =
+      dynamic_cast<genie::geometry::ROOTGeomAnalyzer*>(fGeomD);
+    if ( ! rgeom ) return false;
+
+    // nuclei within the top volume, plus free nucleons
+    const genie::PDGCodeList& tgtlist = rgeom->ListOfTargetNuclei();
+    if ( tgtlist.empty() ) return false;
+    targets.insert(tgtlist.begin(),tgtlist.end());
+    targets.insert(genie::kPdgTgtFreeP);
+    targets.insert(genie::kPdgTgtFreeN);
+
+    // flavors from the flux, or anything if a mixer might change them
+    std::string mixer = fMixerConfig;
+    size_t first = mixer.find_first_not_of(" \t\n");
+    mixer = ( first == std::string::npos ) ? "" :
+      mixer.substr(first,mixer.find_first_of(" \t\n",first)-first);
+    if ( mixer != "none" && mixer != "" ) {
+      probes = { genie::kPdgNuE,   genie::kPdgAntiNuE,
+                 genie::kPdgNuMu,  genie::kPdgAntiNuMu,
+                 genie::kPdgNuTau, genie::kPdgAntiNuTau };
+    } else {
+      probes.insert(fGenFlavors.begin(),fGenFlavors.end());
+    }
+    return ! probes.empty();
+  }
+
+  //--------------------------------------------------
+  double GENIEHelper::ExposureProbScale() const
+  {
+    // normally GMCJDriver scales interaction probabilities up by
+    // 1/GlobProbScale (and then rejects), so each accepted ray stands
+    // for less exposure; forced interactions are not scaled: each ray
+    // thrown is its full share of the flux driver's exposure
+    if ( fForceInteraction ) return 1.0;
+    return fDriver->GlobProbScale();
+  }
+
+  //--------------------------------------------------
+  GENIEHelperStats GENIEHelper::Stats() const
+  {
+    GENIEHelperStats stats(fStats);
+
+    // the flux drivers keep their own count of rays thrown
+    if ( fFluxExposureI ) {
+      stats.nFluxRays = fFluxExposureI->NFluxNeutrinos();
+    } else if ( genie::flux::GPowerSpectrumAtmoFlux* psflux =
+                dynamic_cast<genie::flux::GPowerSpectrumAtmoFlux*>(fFluxD) ) {
+      stats.nFluxRays = psflux->NFluxNeutrinos();
+    } else if ( genie::flux::GAtmoFlux* atmoflux =
+                dynamic_cast<genie::flux::GAtmoFlux*>(fFluxD) ) {
+      stats.nFluxRays = atmoflux->NFluxNeutrinos();
+    } else if ( genie::flux::GAliasTableFlux* aliasflux =
+                dynamic_cast<genie::flux::GAliasTableFlux*>(fFluxD) ) {
+      stats.nFluxRays = aliasflux->NFluxNeutrinos();
+    }
+    return stats;
+  }
+
   //--------------------------------------------------
   double GENIEHelper::TotalHistFlux()
   {
@@ -663,12 +854,15 @@ namespace evgb {
     //   fDriver->SetEventGeneratorList(RunOpt::Instance()->EventGeneratorList());
     fDriver->SetEventGeneratorList(fEventGeneratorList);
 
+    // initialize the Geometry first, its list of target nuclei
+    // determines which cross section splines need to be read
+    InitializeGeometry();
+
     // Figure out which cross section file to use
     // post R-2_8_0 this actually triggers reading the file
     ReadXSecTable();
 
-    // initialize the Geometry and Flux drivers
-    InitializeGeometry();
+    // initialize the Flux driver
     InitializeFluxDriver();
 
     fDriver->UseFluxDriver(fFluxD2GMCJD);
@@ -678,9 +872,49 @@ namespace evgb {
     ConfigGeomScan();      // could trigger fDriver->UseMaxPathLengths(*xmlfile*)
 
     fDriver->Configure();  // could trigger GeomDriver::ComputeMaxPathLengths()
+    SaveMaxPathCache();    // so the next job doesn't have to
+    if ( fScanXmlFile != "" ) {
+      std::remove(fScanXmlFile.c_str());  // read by Configure()
+      fScanXmlFile = "";
+    }
     fDriver->UseSplines();
     fDriver->ForceSingleProbScale();
 
+    // every ray that reaches the geometry interacts; GENIE carries the
+    // interaction probability as the event weight (GTruth::fweight)
+    if ( fForceInteraction ) {
+#ifdef GENIE_PRE_R3
+      throw cet::exception("GENIEHelper")
+        << "ForceInteraction requires GENIE R-3 or later";
+#else
+      fDriver->ForceInteraction();
+#endif
+      mf::LogInfo("GENIEHelper")
+        << "forcing every flux neutrino to interact, events are weighted"
+        << " by their interaction probability";
+      if ( fFluxType.find("histogram") == 0 ||
+           fFluxType.find("mono")      == 0 ||
+           fFluxType.find("function")  == 0    ) {
+        mf::LogWarning("GENIEHelper")
+          << "ForceInteraction with FluxType " << fFluxType
+          << ": spills are counted in events, exposure has no meaning";
+      }
+    }
+
+    // things Sample() needs for every event
+    fTopVol        = fGeoManager->FindVolumeFast(fTopVolume.c_str());
+    fWorldVol      = fGeoManager->FindVolumeFast(fWorldVolume.c_str());
+    fFluxExposureI = dynamic_cast<genie::flux::GFluxExposureI*>(fFluxD);
+    fFluxBlender   = dynamic_cast<genie::flux::GFluxBlender*>(fFluxD2GMCJD);
+    fGenConfig.clear();
+    if(fFluxType.find("PowerSpectrum") != std::string::npos){
+      fGenConfig.emplace("SpectralIndex", std::to_string(fAtmoSpectralIndex));
+    }
+    if ( fForceInteraction ) {
+      // weight (in GTruth) is the probability, not a GlobProbScale'd acceptance
+      fGenConfig.emplace("ForcedInteraction", "true");
+    }
+
     if ( fFluxType.find("histogram") == 0 && fEventsPerSpill < 0.01 ) {
       // fluxes are assumed to be given in units of neutrinos/cm^2/1e20POT/energy
       // integral over all fluxes removes energy dependence
@@ -753,6 +987,7 @@ namespace evgb {
     if ( tmpFluxType.find("ntuple") != std::string::npos ) tmpFluxType = "tree_numi";
     if ( tmpFluxType.find("numi")   != std::string::npos ) tmpFluxType = "tree_numi";
     if ( tmpFluxType.find("dk2nu")  != std::string::npos ) tmpFluxType = "tree_dk2nu";
+    if ( tmpFluxType.find("columnar") != std::string::npos ) tmpFluxType = "tree_columnar";
 
     fFluxType = tmpFluxType;
   }
@@ -842,6 +1077,48 @@ namespace evgb {
 
   }
 
+  //--------------------------------------------------
+  void GENIEHelper::AtmoAutoRadii()
+  {
+    /// Smallest generation surface that still covers the top volume:
+    /// atmo_ rays are aimed at the world origin, so the sphere around
+    /// the origin enclosing the top volume's bounding sphere
+
+    genie::geometry::ROOTGeomAnalyzer* rgeom =
+      dynamic_cast<genie::geometry::ROOTGeomAnalyzer*>(fGeomD);
+    TGeoVolume* topvol = fGeoManager->FindVolumeFast(fTopVolume.c_str());
+    TGeoBBox*   bbox   = ( topvol ) ? dynamic_cast<TGeoBBox*>(topvol->GetShape()) : 0;
+    if ( ! rgeom || ! bbox ) {
+      throw cet::exception("GENIEHelper")
+        << "AtmoAutoRadii can't find the extent of TopVolume " << fTopVolume;
+    }
+    if ( fAtmoRadiusMargin < 0 ) {
+      throw cet::exception("GENIEHelper")
+        << "AtmoRadiusMargin " << fAtmoRadiusMargin << " can't be negative";
+    }
+
+    // bounding box center (top volume frame) and half diagonal, in the
+    // geometry's units; the flux drivers work in SI (m)
+    const Double_t* origin = bbox->GetOrigin();
+    TVector3 center(origin[0],origin[1],origin[2]);
+    TVector3 halfdiag(bbox->GetDX(),bbox->GetDY(),bbox->GetDZ());
+    rgeom->Top2Master(center);
+    rgeom->Local2SI(center);
+    rgeom->Local2SI(halfdiag);
+
+    double radius = center.Mag() + halfdiag.Mag() + fAtmoRadiusMargin;
+
+    mf::LogInfo("GENIEHelper")
+      << "AtmoAutoRadii: TopVolume " << fTopVolume
+      << " bounding sphere at (" << center.X() << "," << center.Y()
+      << "," << center.Z() << ") m, radius " << halfdiag.Mag() << " m;"
+      << " generation surface (" << fAtmoRl << "," << fAtmoRt << ") -> ("
+      << radius << "," << radius << ")";
+
+    fAtmoRl = radius;
+    fAtmoRt = radius;
+  }
+
   //--------------------------------------------------
   void GENIEHelper::HistogramFluxCheck()
   {
@@ -1179,6 +1456,11 @@ namespace evgb {
   //--------------------------------------------------
   void GENIEHelper::InitializeFluxDriver()
   {
+    // background copies had geometry & cross sections to overlap with
+    FinishFluxStaging();
+
+    // the geometry is known by now, fit the atmo generation surface to it
+    if ( fAtmoAutoRadii && fFluxType.find("atmo_") == 0 ) AtmoAutoRadii();
 
     // simplify a lot of things ...
     // but for now this part only handles the 3 ntuple styles
@@ -1188,7 +1470,7 @@ namespace evgb {
     std::string fluxName = "";
 
     // what looks like the start of a fully qualified class name
-    // or one of our tree_ classes "numi" "simple" "dk2nu"
+    // or one of our tree_ classes "numi" "simple" "dk2nu" "columnar"
     // but only know how to configure those that dervie from:
     //    genie::flux::GFluxFileConfigI*
     if ( fFluxType.find("genie::flux::")   != std::string::npos )
@@ -1199,6 +1481,8 @@ namespace evgb {
       fluxName = "genie::flux::GSimpleNtpFlux";
     else if ( fFluxType.find("tree_dk2nu")   == 0 )
       fluxName = "genie::flux::GDk2NuFlux";
+    else if ( fFluxType.find("tree_columnar") == 0 )
+      fluxName = "genie::flux::GColumnarFlux";
 
     if ( fluxName != "" ) {
       // any fall through to hopefully be handled below ...
@@ -1216,7 +1500,36 @@ namespace evgb {
         // initialize them
         genie::flux::GFluxFileConfigI* ffileconfig =
           dynamic_cast<genie::flux::GFluxFileConfigI*>(fFluxD);
+        if ( ffileconfig && fFluxType.find("tree_dk2nu") == 0 &&
+             UseProjectedFlux(ffileconfig->GetXMLFileBase()) ) {
+          // same rays, already projected to fDetLocation's window
+          delete fFluxD;
+          fFluxD = fluxDFactory.GetFluxDriver("genie::flux::GColumnarFlux");
+          ffileconfig = dynamic_cast<genie::flux::GFluxFileConfigI*>(fFluxD);
+        }
         if ( ffileconfig ) {
+          // use each entry several times (before loading, the drivers
+          // scale their POT per entry by it); numi & dk2nu pick a new
+          // point in the window, with its own energy & weight, each time
+          if ( fFluxEntryReuse > 1 ) {
+            genie::flux::GNuMIFlux* gnumi =
+              dynamic_cast<genie::flux::GNuMIFlux*>(fFluxD);
+            genie::flux::GSimpleNtpFlux* gsimple =
+              dynamic_cast<genie::flux::GSimpleNtpFlux*>(fFluxD);
+            genie::flux::GDk2NuFlux* gdk2nu =
+              dynamic_cast<genie::flux::GDk2NuFlux*>(fFluxD);
+            if      ( gnumi   ) gnumi->SetEntryReuse(fFluxEntryReuse);
+            else if ( gdk2nu  ) gdk2nu->SetEntryReuse(fFluxEntryReuse);
+            else if ( gsimple ) {
+              gsimple->SetEntryReuse(fFluxEntryReuse);
+              mf::LogWarning("GENIEHelper")
+                << "FluxEntryReuse " << fFluxEntryReuse << " with gsimple:"
+                << " rays are already on the window and are reused as they are";
+            } else {
+              mf::LogWarning("GENIEHelper")
+                << "FluxEntryReuse not supported for FluxType " << fFluxType;
+            }
+          }
           ffileconfig->LoadBeamSimData(fSelectedFluxFiles,fDetLocation);
           ffileconfig->PrintConfig();
           // initialize to only use neutrino flavors requested by user
@@ -1229,7 +1542,23 @@ namespace evgb {
       }
     } // is genie::flux:: or tree_{numi|simple|dk2nu}
 
-    if ( fFluxType.find("histogram") == 0 ) {
+    if ( fFluxType.find("histogram") == 0 && fFluxAliasTable ) {
+
+      // same spectra and cylinder, constant time per ray
+      genie::flux::GAliasTableFlux* aliasFlux = new genie::flux::GAliasTableFlux();
+      int ctr = 0;
+      for ( std::vector<int>::iterator i = fGenFlavors.begin(); i != fGenFlavors.end(); i++ ) {
+        aliasFlux->AddEnergySpectrum(*i, fFluxHistograms[ctr]);
+        ++ctr;
+      }
+      aliasFlux->SetNuDirection(fBeamDirection);
+      aliasFlux->SetBeamSpot(fBeamCenter);
+      aliasFlux->SetTransverseRadius(fBeamRadius);
+
+      fFluxD = aliasFlux;
+
+    } // end if using a histogram (alias table)
+    else if ( fFluxType.find("histogram") == 0 ) {
 
       genie::flux::GCylindTH1Flux* histFlux = new genie::flux::GCylindTH1Flux();
 
@@ -1263,6 +1592,25 @@ namespace evgb {
       fFluxD = monoflux; // dynamic_cast<genie::GFluxI *>(monoflux);
 
     } //end if using monoenergetic beam
+    else if ( fFluxType.find("function") == 0 && fFluxAliasTable ) {
+
+      // the binning only sets the table size, not the cost per ray
+      genie::flux::GAliasTableFlux* aliasFlux = new genie::flux::GAliasTableFlux();
+      TF1* input_func = new TF1("input_func", fFunctionalFlux.c_str(), fEmin, fEmax);
+      TH1D* spectrum = new TH1D("spectrum", "neutrino flux", fFunctionalBinning, fEmin, fEmax);
+      spectrum->Add(input_func);
+
+      for ( std::vector<int>::iterator i = fGenFlavors.begin(); i != fGenFlavors.end(); i++ ) {
+        aliasFlux->AddEnergySpectrum(*i, spectrum);
+      }
+      aliasFlux->SetNuDirection(fBeamDirection);
+      aliasFlux->SetBeamSpot(fBeamCenter);
+      aliasFlux->SetTransverseRadius(fBeamRadius);
+
+      fFluxD = aliasFlux;
+      delete spectrum;  // contents were copied
+      delete input_func;
+    } //end if using function beam (alias table)
     else if ( fFluxType.find("function") == 0 ) {
 
       genie::flux::GCylindTH1Flux* histFlux = new genie::flux::GCylindTH1Flux();
@@ -1288,6 +1636,27 @@ namespace evgb {
       power_flux->SetFlavors(fGenFlavors);
       power_flux->SetMinEnergy(fAtmoEmin);
       power_flux->SetMaxEnergy(fAtmoEmax);
+      power_flux->SetImportanceSampling(fAtmoImportance);
+      if ( fAtmoQuasiRandom ) {
+        if ( fAtmoQuasiOffset < 0 || fAtmoQuasiScramble < 0 ) {
+          throw cet::exception("GENIEHelper")
+            << "AtmoQuasiRandomOffset " << fAtmoQuasiOffset
+            << " and AtmoQuasiRandomScramble " << fAtmoQuasiScramble
+            << " must not be negative";
+        }
+        // a scramble from RndFlux differs per helper, a fixed one doesn't
+        if ( fAtmoQuasiScramble != 0 ) {
+          std::pair<int,int> claim(fAtmoQuasiScramble,fAtmoQuasiOffset);
+          if ( ! QuasiRandomClaims().insert(claim).second ) {
+            throw cet::exception("GENIEHelper")
+              << "another GENIEHelper in this process already uses AtmoQuasiRandomScramble "
+              << fAtmoQuasiScramble << " with AtmoQuasiRandomOffset " << fAtmoQuasiOffset
+              << "; both would generate the same rays, give each its own offset";
+          }
+          fAtmoQuasiClaimed = true;
+        }
+        power_flux->SetQuasiRandom(true,fAtmoQuasiOffset,fAtmoQuasiScramble);
+      }
 
       mf::LogInfo("GENIEHelper") << "Setting Emin=" << fEmin << " ; Emax=" << fEmax;
 
@@ -1407,6 +1776,53 @@ namespace evgb {
         << __FILE__ << ":" << __LINE__ << "\n";
     }
 
+    //
+    // Drop rays outside an energy window before GMCJDriver does any work
+    // on them; they still count towards the exposure.  Only for drivers
+    // that keep exposure (the others have their own energy limits).
+    //
+    if ( ! fFluxEnergyWindow.empty() ) {
+      if ( fFluxEnergyWindow.size() != 2 ||
+           fFluxEnergyWindow[0] >= fFluxEnergyWindow[1] ) {
+        throw cet::exception("GENIEHelper")
+          << "FluxEnergyWindow should be [emin,emax] in GeV";
+      }
+      if ( fFluxType.find("tree_") != 0 ) {
+        mf::LogWarning("GENIEHelper")
+          << "FluxEnergyWindow is only used for tree_ fluxes, not " << fFluxType;
+      } else {
+        fFluxWindowD = new evgb::GFluxEnergyWindow(fFluxD,fFluxEnergyWindow[0],
+                                                   fFluxEnergyWindow[1]);
+        fFluxD = fFluxWindowD;
+        mf::LogInfo("GENIEHelper")
+          << "only flux rays with " << fFluxEnergyWindow[0] << " <= E <= "
+          << fFluxEnergyWindow[1] << " GeV are passed to GENIE";
+      }
+    }
+
+    //
+    // Read the rays ahead on a background thread?  Only worth it for the
+    // file based drivers; a GFluxBlender draws from the same RndFlux stream
+    // as the driver, so the two can't run on different threads.
+    //
+    if ( fFluxReadAhead > 0 && fFluxType.find("tree_") == 0 ) {
+      std::istringstream mixcfg(fMixerConfig);
+      std::string mixkey;
+      mixcfg >> mixkey;
+      if ( mixkey != "" && mixkey != "none" ) {
+        mf::LogWarning("GENIEHelper")
+          << "FluxReadAhead is not used together with MixerConfig \""
+          << mixkey << "\"";
+      } else {
+        // the worker reads TTrees while the main thread uses the geometry
+        ROOT::EnableThreadSafety();
+        fFluxReadAheadD = new evgb::GFluxReadAhead(fFluxD,fFluxReadAhead);
+        fFluxD = fFluxReadAheadD;
+        mf::LogInfo("GENIEHelper")
+          << "reading " << fFluxReadAhead << " flux rays ahead";
+      }
+    }
+
     //
     // Is the user asking to do flavor mixing?
     //
@@ -1519,6 +1935,7 @@ namespace evgb {
 
     double safetyfactor = 0;
     int    writeout = 0;
+    int    scanNPoints = 0, scanNRays = 0, scanNParticles = 0;
     if (        scanmethod.find("box") == 0 ) {
       // use box method
       int np = (int)vals[0];
@@ -1533,6 +1950,8 @@ namespace evgb {
         << nr << " rays";
       rgeom->SetScannerNPoints(np);
       rgeom->SetScannerNRays(nr);
+      scanNPoints = np;
+      scanNRays   = nr;
     } else if ( scanmethod.find("flux") == 0 ) {
       // use flux method
       int np = (int)vals[0];
@@ -1553,6 +1972,7 @@ namespace evgb {
         << ( (np>0) ? "" : " with ray energy pushed to flux driver maximum" );
       rgeom->SetScannerFlux(fFluxD);
       rgeom->SetScannerNParticles(np);
+      scanNParticles = np;
     }
     else{
       // unknown
@@ -1564,37 +1984,274 @@ namespace evgb {
         << "ConfigGeomScan setting safety factor to " << safetyfactor;
       rgeom->SetMaxPlSafetyFactor(safetyfactor);
     }
+
+    // a previous job with the same geometry and scan may have saved its result
+    if ( fMaxPathCacheDir != "" ) {
+      std::string key = MaxPathCacheKey();
+      if ( key == "" ) {
+        mf::LogWarning("GENIEHelper")
+          << "can't hash geometry \"" << fGeoFile << "\" or the flux files,"
+          << " not caching GeomScan";
+      } else {
+        std::string cached = fMaxPathCacheDir + "/maxpl-" + key + ".xml";
+        genie::PathLengthList check;
+        if ( access(cached.c_str(),R_OK) == 0 &&
+             check.LoadFromXml(cached) == genie::kXmlOK ) {
+          mf::LogInfo("GENIEHelper")
+            << "ConfigGeomScan getting MaxPathLengths from cache \""
+            << cached << "\"";
+          fDriver->UseMaxPathLengths(cached);
+          if ( writeout != 0 ) {
+            mf::LogInfo("GENIEHelper")
+              << "GeomScan not run, no maxpathlength.xml written (see cache file)";
+          }
+          return;
+        }
+        fMaxPathCacheFile = cached;
+      }
+    }
+
+    // trace the rays here, in parallel, rather than in GMCJDriver::Configure()
+    if ( fGeomScanThreads != 0 ) {
+      ParallelGeomScan(rgeom,scanNPoints,scanNRays,scanNParticles);
+    }
+
     if ( writeout != 0 ) SetMaxPathOutInfo();
   }
 
   //--------------------------------------------------
-  void GENIEHelper::SetMaxPathOutInfo()
+  bool GENIEHelper::ParallelGeomScan(genie::geometry::ROOTGeomAnalyzer* rgeom,
+                                     int npoints, int nrays, int nparticles)
   {
-    // create an info string based on:
-    // ROOT geometry, TopVolume, FiducialCut, GeomScan, Flux
+    if ( nparticles < 0 ) {
+      mf::LogInfo("GENIEHelper")
+        << "GeomScan pushing ray energies isn't done in parallel,"
+        << " leaving the scan to GENIE";
+      return false;
+    }
+
+    TGeoVolume* topvol = fGeoManager->FindVolumeFast(fTopVolume.c_str());
+    const genie::PDGCodeList& targets = rgeom->ListOfTargetNuclei();
+    evgb::GeomMaxPathScanner scanner(fGeoManager,topvol,targets,fGeomScanThreads);
 
+    if ( nparticles == 0 ) {
+      scanner.ScanBox(npoints,nrays,fHelperRandom->GetSeed());
+    } else {
+      // the flux driver isn't thread safe: collect the rays first
+      std::vector<TVector3> pos, dir;
+      pos.reserve(nparticles);
+      dir.reserve(nparticles);
+      for ( int ipart = 0; ipart < nparticles; ++ipart ) {
+        if ( ! fFluxD->GenerateNext() ) {
+          if ( fFluxD->End() ) break;
+          continue;
+        }
+        TVector3 x = fFluxD->Position().Vect();
+        TVector3 p = fFluxD->Momentum().Vect().Unit();
+        rgeom->SI2Local(x);
+        rgeom->Master2Top(x);
+        rgeom->Master2TopDir(p);
+        pos.push_back(x);
+        dir.push_back(p);
+      }
+      // rays used for the scan shouldn't count towards the exposure
+      fFluxD->Clear("CycleHistory");
+      scanner.ScanRays(pos,dir);
+    }
+
+    genie::PathLengthList* maxpl = new genie::PathLengthList(targets);
+    scanner.FillMaxPathLengths(*maxpl);
+    rgeom->Local2SI(*maxpl);
+
+    // check our path length bookkeeping against GENIE's for the longest
+    // ray (GENIE also applies the fiducial cut, so only compare without)
+    TVector3 xray, pray;
+    int      pdgray;
+    if ( ( fFiducialCut == "" || fFiducialCut == "none" ) &&
+         scanner.LongestRay(xray,pray,pdgray) ) {
+      rgeom->Top2Master(xray);
+      rgeom->Local2SI(xray);
+      rgeom->Top2MasterDir(pray);
+      const genie::PathLengthList& genpl =
+        rgeom->ComputePathLengths(TLorentzVector(xray,0),TLorentzVector(pray,1));
+      double ours   = maxpl->PathLength(pdgray);
+      double theirs = genpl.PathLength(pdgray);
+      if ( std::fabs(ours-theirs) > 1.0e-4*std::fabs(theirs) ) {
+        mf::LogWarning("GENIEHelper")
+          << "parallel GeomScan disagrees with GENIE for " << pdgray
+          << " (" << ours << " vs " << theirs << "), leaving the scan to GENIE";
+        delete maxpl;
+        return false;
+      }
+    }
+
+    double safetyfactor = rgeom->MaxPlSafetyFactor();
+    for ( int pdg : targets ) maxpl->ScalePathLength(pdg,safetyfactor);
+
+    // GMCJDriver only takes a max path length list from a file
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string xmlfile = std::string( ( tmpdir ) ? tmpdir : "/tmp" ) +
+      "/evgb-maxpl-" + std::to_string(getpid()) + ".xml";
+    maxpl->SaveAsXml(xmlfile);
+    fDriver->UseMaxPathLengths(xmlfile);
+    fScanXmlFile = xmlfile;
+    delete fScannedMaxPath;
+    fScannedMaxPath = maxpl;
+
+    mf::LogInfo("GENIEHelper")
+      << "GeomScan traced " << scanner.NRays() << " rays with "
+      << scanner.NThreads() << " threads in " << scanner.Seconds() << " s"
+      << " (safety factor " << safetyfactor << ")";
+    return true;
+  }
+
+  //--------------------------------------------------
+  void GENIEHelper::SetMaxPathOutInfo()
+  {
     mf::LogInfo("GENIEHelper") << "about to create MaxPathOutInfo";
 
-    fMaxPathOutInfo = "\n";
-    fMaxPathOutInfo += "   FluxType:     " + fFluxType + "\n";
-    fMaxPathOutInfo += "   BeamName:     " + fBeamName + "\n";
-    fMaxPathOutInfo += "   FluxFiles:    ";
-    std::vector<string>::iterator ffitr = fSelectedFluxFiles.begin();
-    for ( ; ffitr != fSelectedFluxFiles.end() ; ++ffitr )
-      fMaxPathOutInfo += "\n         " + *ffitr;
-    fMaxPathOutInfo += "\n";
-    fMaxPathOutInfo += "   DetLocation:  " + fDetLocation + "\n";
-    fMaxPathOutInfo += "   ROOTFile:     " + fGeoFile     + "\n";
-    fMaxPathOutInfo += "   WorldVolume:  " + fWorldVolume + "\n";
-    fMaxPathOutInfo += "   TopVolume:    " + fTopVolume   + "\n";
-    fMaxPathOutInfo += "   FiducialCut:  " + fFiducialCut + "\n";
-    fMaxPathOutInfo += "   GeomScan:     " + fGeomScan    + "\n";
+    fMaxPathOutInfo = MaxPathInfo();
 
     mf::LogInfo("GENIEHelper") << "MaxPathOutInfo: \""
                                << fMaxPathOutInfo << "\"";
 
   }
 
+  //--------------------------------------------------
+  std::string GENIEHelper::MaxPathInfo() const
+  {
+    // create an info string based on:
+    // ROOT geometry, TopVolume, FiducialCut, GeomScan, Flux
+
+    std::string info = "\n";
+    info += "   FluxType:     " + fFluxType + "\n";
+    info += "   BeamName:     " + fBeamName + "\n";
+    info += "   FluxFiles:    ";
+    std::vector<string>::const_iterator ffitr = fSelectedFluxFiles.begin();
+    for ( ; ffitr != fSelectedFluxFiles.end() ; ++ffitr )
+      info += "\n         " + *ffitr;
+    info += "\n";
+    info += "   DetLocation:  " + fDetLocation + "\n";
+    info += "   ROOTFile:     " + fGeoFile     + "\n";
+    info += "   WorldVolume:  " + fWorldVolume + "\n";
+    info += "   TopVolume:    " + fTopVolume   + "\n";
+    info += "   FiducialCut:  " + fFiducialCut + "\n";
+    info += "   GeomScan:     " + fGeomScan    + "\n";
+
+    return info;
+  }
+
+  //--------------------------------------------------
+  std::string GENIEHelper::MaxPathCacheKey() const
+  {
+    // everything that determines the scan result: the geometry contents,
+    // where in it events go, and how the scan is done
+    uint64_t hash;
+    if ( ! evgb::util::HashFile(fGeoFile,hash) ) return "";
+    hash = evgb::util::HashString(fWorldVolume,hash);
+    hash = evgb::util::HashString(fTopVolume,hash);
+    hash = evgb::util::HashString(fFiducialCut,hash);
+    hash = evgb::util::HashString(fGeomScan,hash);
+
+    // for a "flux" scan the rays come from the flux files (which might
+    // have been copied locally, so go by name and contents, not full path)
+    // and from whatever configuration moves, turns or selects them
+    std::string scanmethod = fGeomScan.substr(0,4);
+    std::transform(scanmethod.begin(),scanmethod.end(),scanmethod.begin(),::tolower);
+    if ( scanmethod == "flux" ) {
+      hash = evgb::util::HashString(fFluxType,hash);
+      hash = evgb::util::HashString(fBeamName,hash);
+      hash = evgb::util::HashString(fDetLocation,hash);
+      hash = evgb::util::HashString(fFluxRotCfg,hash);
+      hash = evgb::util::HashBytes(fFluxRotValues.data(),
+                                   fFluxRotValues.size()*sizeof(double),hash);
+      hash = evgb::util::HashBytes(&fFluxUpstreamZ,sizeof(fFluxUpstreamZ),hash);
+      hash = evgb::util::HashBytes(&fFluxEntryReuse,sizeof(fFluxEntryReuse),hash);
+      hash = evgb::util::HashBytes(fFluxEnergyWindow.data(),
+                                   fFluxEnergyWindow.size()*sizeof(double),hash);
+
+      // the flux window comes from the driver's XML file
+      genie::GFluxI* realFluxD = fFluxD;
+      if ( fFluxReadAheadD ) realFluxD = fFluxReadAheadD->GetFluxGenerator();
+      if ( fFluxWindowD    ) realFluxD = fFluxWindowD->GetFluxGenerator();
+      genie::flux::GFluxFileConfigI* ffileconfig =
+        dynamic_cast<genie::flux::GFluxFileConfigI*>(realFluxD);
+      if ( ffileconfig ) {
+        hash = evgb::util::HashString(ffileconfig->GetXMLFileBase(),hash);
+      }
+
+      // the histogram, function & mono fluxes fire their rays from here
+      if ( fFluxType.find("histogram") == 0 ||
+           fFluxType.find("function")  == 0 ||
+           fFluxType.find("mono")      == 0    ) {
+        double beam[7] = { fBeamCenter.X(),    fBeamCenter.Y(),    fBeamCenter.Z(),
+                           fBeamDirection.X(), fBeamDirection.Y(), fBeamDirection.Z(),
+                           fBeamRadius };
+        hash = evgb::util::HashBytes(beam,sizeof(beam),hash);
+      }
+      // a reprocessed file often keeps its name and size, so also sample
+      // its contents (ROOT files keep their creation times and key list
+      // at the start and end); the mtime would change with every copy
+      const size_t kFluxSampleBytes = 64*1024;
+      for ( auto const& ffile : fSelectedFluxFiles ) {
+        std::string ffname = gSystem->BaseName(ffile.c_str());
+        hash = evgb::util::HashString(ffname,hash);
+        if ( ! evgb::util::HashFileSample(ffile,kFluxSampleBytes,hash) ) {
+          return "";
+        }
+      }
+    }
+    return evgb::util::HashToHex(hash);
+  }
+
+  //--------------------------------------------------
+  void GENIEHelper::WriteMaxPathLengths(std::string const& filename,
+                                        std::string const& info) const
+  {
+    genie::geometry::ROOTGeomAnalyzer* rgeom =
+      dynamic_cast<genie::geometry::ROOTGeomAnalyzer*>(fGeomD);
+
+    const genie::PathLengthList& maxpath =
+      ( fScannedMaxPath ) ? *fScannedMaxPath : rgeom->GetMaxPathLengths();
+
+    maxpath.SaveAsXml(filename);
+    // append extra info to file
+    std::ofstream mpfile(filename.c_str(), std::ios_base::app);
+    mpfile
+      << std::endl
+      << "<!-- this file is only relevant for a setup compatible with:"
+      << std::endl
+      << info
+      << std::endl
+      << "-->"
+      << std::endl;
+    mpfile.close();
+  }
+
+  //--------------------------------------------------
+  void GENIEHelper::SaveMaxPathCache()
+  {
+    if ( fMaxPathCacheFile == "" ) return;
+
+    // write next to the final name and rename, so that concurrent jobs
+    // never pick up a partial file
+    if ( ! evgb::util::MakeDirs(fMaxPathCacheDir) ) {
+      mf::LogWarning("GENIEHelper")
+        << "can't create MaxPathCacheDir \"" << fMaxPathCacheDir << "\"";
+      return;
+    }
+    std::string tmpname = fMaxPathCacheFile + ".tmp." + std::to_string(getpid());
+    WriteMaxPathLengths(tmpname,MaxPathInfo());
+    if ( std::rename(tmpname.c_str(),fMaxPathCacheFile.c_str()) != 0 ) {
+      std::remove(tmpname.c_str());
+      mf::LogWarning("GENIEHelper")
+        << "could not save GeomScan result as \"" << fMaxPathCacheFile << "\"";
+      return;
+    }
+    mf::LogInfo("GENIEHelper")
+      << "saved GeomScan result as \"" << fMaxPathCacheFile << "\"";
+  }
+
   //--------------------------------------------------
   bool GENIEHelper::Stop()
   {
@@ -1631,13 +2288,20 @@ namespace evgb {
       long int nNeutrinos;
 
       if(fFluxType.find("PowerSpectrum") != std::string::npos){
-        nNeutrinos = dynamic_cast<genie::flux::GPowerSpectrumAtmoFlux *>(fFluxD)->NFluxNeutrinos();
-        fTotalExposure = nNeutrinos/fGenFlavors.size()/fDriver->GlobProbScale();
+        genie::flux::GPowerSpectrumAtmoFlux* psflux =
+          dynamic_cast<genie::flux::GPowerSpectrumAtmoFlux *>(fFluxD);
+        nNeutrinos = psflux->NFluxNeutrinos();
+        // importance sampling weights already share the rays among the flavors
+        size_t nflavors = ( psflux->ImportanceSampling() ) ? 1 : fGenFlavors.size();
+        fTotalExposure = nNeutrinos/nflavors/ExposureProbScale();
         mf::LogInfo("GENIEHelper")
-        << "===> Atmo Pscale*Ngen/Nflavours = " << fTotalExposure;
+        << "===> Atmo Pscale*Ngen/Nflavours = " << fTotalExposure
+        << ( ( nflavors == 1 && fGenFlavors.size() > 1 ) ? " (importance sampling: all flavors)" : "" );
       }
       else{
         nNeutrinos = dynamic_cast<genie::flux::GAtmoFlux *>(fFluxD)->NFluxNeutrinos();
+        // fAtmoRt is the radius the driver used (AtmoAutoRadii may have set it);
+        // PowerSpectrum carries the area in its weights instead
         fTotalExposure = nNeutrinos * 1.0e4 / (TMath::Pi() * fAtmoRt*fAtmoRt);
         mf::LogInfo("GENIEHelper")
         << "===> Atmo EXPOSURE = " << fTotalExposure << " seconds.";
@@ -1652,6 +2316,7 @@ namespace evgb {
     }
 
     // made it to here, means need to reset the counters
+    ++fStats.nSpills;
     fSpillEvents   = 0;
     fSpillExposure = 0.;
     fHistEventsPerSpill = fHelperRandom->Poisson(fXSecMassPOT*fTotalHistFlux);
@@ -1661,16 +2326,79 @@ namespace evgb {
   //--------------------------------------------------
   bool GENIEHelper::Sample(simb::MCTruth &truth, simb::MCFlux  &flux, simb::GTruth &gtruth)
   {
+    // run GENIE for one flux ray, then translate any resulting record
+    // into the art products
+    if ( ! GenerateRecord(flux) ) return false;
+    FillTruthRecords(truth,flux,gtruth);
+    return true;
+  }
+
+  //--------------------------------------------------
+  size_t GENIEHelper::SampleBatch(size_t n,
+                                  std::vector<simb::MCTruth> &truths,
+                                  std::vector<simb::MCFlux>  &fluxes,
+                                  std::vector<simb::GTruth>  &gtruths,
+                                  std::function<void(size_t)> const& onEvent)
+  {
+    // guess at the final size; a spill of ntuple POT can't be known up front
+    size_t nexpect = n;
+    if ( n == 0 && fEventsPerSpill > 0 ) nexpect = static_cast<size_t>(fEventsPerSpill);
+    truths.reserve(truths.size()+nexpect);
+    fluxes.reserve(fluxes.size()+nexpect);
+    gtruths.reserve(gtruths.size()+nexpect);
+
+    size_t nadded = 0;
+    fGeoManager->SetTopVolume(fTopVol);
+
+    // check the count first: Stop() resets the spill when it says "done"
+    while ( ( n == 0 || nadded < n ) && ! Stop() ) {
+
+      simb::MCFlux flux;
+      if ( ! GenerateRecordInTopVolume(flux) ) continue;
+
+      truths.emplace_back();
+      gtruths.emplace_back();
+      fluxes.push_back(std::move(flux));
+      FillTruthRecords(truths.back(),fluxes.back(),gtruths.back());
+      ++nadded;
+
+      if ( onEvent ) onEvent(truths.size()-1);
+    }
+
+    fGeoManager->SetTopVolume(fWorldVol);
+    return nadded;
+  }
+
+  //--------------------------------------------------
+  bool GENIEHelper::GenerateRecord(simb::MCFlux &flux)
+  {
+    // everything done here touches GENIE singletons, the flux driver
+    // or the shared TGeoManager
+
     // set the top volume for the geometry
-    fGeoManager->SetTopVolume(fGeoManager->FindVolumeFast(fTopVolume.c_str()));
+    fGeoManager->SetTopVolume(fTopVol);
+
+    bool viableInteraction = GenerateRecordInTopVolume(flux);
 
+    // set the top volume of the geometry back to the world volume
+    fGeoManager->SetTopVolume(fWorldVol);
+
+    return viableInteraction;
+  }
+
+  //--------------------------------------------------
+  bool GENIEHelper::GenerateRecordInTopVolume(simb::MCFlux &flux)
+  {
     if ( fGenieEventRecord ) delete fGenieEventRecord;
 
     // ART Framework plays games with gRandom, undo that if requested
     TRandom* old_gRandom = gRandom;
     if (fUseHelperRndGen4GENIE) gRandom = fHelperRandom;
 
+    auto tstart = std::chrono::steady_clock::now();
     fGenieEventRecord = fDriver->GenerateEvent();
+    fStats.generateEvent.Add(std::chrono::steady_clock::now()-tstart);
+    ++fStats.nRecords;
 
     if (fForceApplyFlxWgt) {
       //const issue:  double flxweight = fDriver->FluxDriver().Weight();
@@ -1687,46 +2415,61 @@ namespace evgb {
 
     // now check if we produced a viable event record
     bool viableInteraction = true;
-    if ( ! fGenieEventRecord ) viableInteraction = false;
+    if ( ! fGenieEventRecord ) {
+      viableInteraction = false;
+      ++fStats.nNullRecords;
+    }
 
     // update the spill total information, then check to see
     // if we got an event record that was valid
 
-    genie::flux::GFluxExposureI* fexposure =
-      dynamic_cast<genie::flux::GFluxExposureI*>(fFluxD);
-    if ( fexposure ) {
+    if ( fFluxExposureI ) {
       fSpillExposure =
-        (fexposure->GetTotalExposure()/fDriver->GlobProbScale()) - fTotalExposure;
+        (fFluxExposureI->GetTotalExposure()/ExposureProbScale()) - fTotalExposure;
     }
     // use GENIE2ART code to fill MCFlux
+    tstart = std::chrono::steady_clock::now();
     evgb::FillMCFlux(fFluxD,flux);
+    fStats.fillMCFlux.Add(std::chrono::steady_clock::now()-tstart);
+
+    // a new run/job # means the flux driver moved on to another file
+    if ( flux.frun != fLastFluxRun ) {
+      if ( fLastFluxRun != kNoFluxRun ) ++fStats.nFluxFileSwitches;
+      fLastFluxRun = flux.frun;
+    }
 
     // if no interaction generated return false
-    if ( ! viableInteraction ) return false;
+    return viableInteraction;
+  }
 
+  //--------------------------------------------------
+  void GENIEHelper::FillTruthRecords(simb::MCTruth &truth, simb::MCFlux &flux,
+                                     simb::GTruth &gtruth)
+  {
     // fill the MCTruth & GTruth information as we have a good interaction
     // these two objects are enough to reconstruct the GENIE record
     // use the new external functions in GENIE2ART
 
     // choose a time within the spill (ns) to shift the vertex times by:
+    auto tstart = std::chrono::steady_clock::now();
     double timeoffset = 0;
     if ( ! fTimeShifter ) {
       timeoffset = fHelperRandom->Uniform()*fRandomTimeOffset;
     } else {
       timeoffset = fTimeShifter->TimeOffset();
     }
+    fStats.timeShifter.Add(std::chrono::steady_clock::now()-tstart);
     // mf::LogInfo("GENIEHelper") << "TimeShifter adding " << timeoffset;
     double spilltime  = fGlobalTimeOffset + timeoffset;
 
-    std::unordered_map<std::string, std::string> genConfig;
-
-    if(fFluxType.find("PowerSpectrum") != std::string::npos){
-      genConfig.emplace("SpectralIndex", std::to_string(fAtmoSpectralIndex));
-    }
-
+    tstart = std::chrono::steady_clock::now();
     evgb::FillMCTruth(fGenieEventRecord, spilltime, truth,
-                      __GENIE_RELEASE__, fTuneName, fAddGenieVtxTime );
+                      __GENIE_RELEASE__, fTuneName, fAddGenieVtxTime, fGenConfig );
+    fStats.fillMCTruth.Add(std::chrono::steady_clock::now()-tstart);
+
+    tstart = std::chrono::steady_clock::now();
     evgb::FillGTruth(fGenieEventRecord, gtruth);
+    fStats.fillGTruth.Add(std::chrono::steady_clock::now()-tstart);
 
     // check to see if we are using flux ntuples but want to
     // make n events per spill
@@ -1788,12 +2531,10 @@ namespace evgb {
     flux.fgenz    = nuray_pos.Z();
     flux.fgen2vtx = ray2vtx.Mag();
 
-    genie::flux::GFluxBlender* blender =
-      dynamic_cast<genie::flux::GFluxBlender*>(fFluxD2GMCJD);
-    if ( blender ) {
-      if ( fUseBlenderDist ) flux.fdk2gen = blender->TravelDist();
+    if ( fFluxBlender ) {
+      if ( fUseBlenderDist ) flux.fdk2gen = fFluxBlender->TravelDist();
       // / if mixing flavors print the state of the blender
-      if ( fDebugFlags & 0x02 ) blender->PrintState();
+      if ( fDebugFlags & 0x02 ) fFluxBlender->PrintState();
     }
 
     if ( fDebugFlags & 0x04 ) {
@@ -1808,10 +2549,6 @@ namespace evgb {
       std::cout << *fGenieEventRecord;
     }
 
-    // set the top volume of the geometry back to the world volume
-    fGeoManager->SetTopVolume(fGeoManager->FindVolumeFast(fWorldVolume.c_str()));
-
-    return true;
   }
 
   //---------------------------------------------------------
@@ -1970,43 +2707,42 @@ namespace evgb {
     bool randomizeFiles = false;
     if ( fFluxType.find("tree_") == 0 ) randomizeFiles = true;
 
+    std::vector<std::pair<std::string,long>> manifestlist;
+    if ( SelectFluxFilesFromManifest(manifestlist) ) {
+      for ( auto const& p : manifestlist ) fSelectedFluxFiles.push_back(p.first);
+      return;
+    }
+
     std::vector<std::string> dirs;
     cet::split_path(fFluxSearchPaths,dirs);
     if ( dirs.empty() ) dirs.push_back(std::string()); // at least null string
 
-    glob_t g;
-    int flags = GLOB_TILDE;   // expand ~ home directories
-
     std::ostringstream patterntext;  // for info/error messages
     std::ostringstream dirstext;     // for info/error messages
 
+    std::vector<std::string>::iterator ditr = dirs.begin();
+    for ( ; ditr != dirs.end(); ++ditr ) {
+      std::string& dalt = *ditr;
+      // if non-null, does it end with a "/"?  if not add one
+      size_t len = dalt.size();
+      if ( len > 0 && dalt.rfind('/') != len-1 ) dalt.append("/");
+      dirstext << "\n\t" << dalt;
+    }
     std::vector<std::string>::const_iterator uitr = fFluxFilePatterns.begin();
-    int ipatt = 0;
-
-    for ( ; uitr != fFluxFilePatterns.end(); ++uitr, ++ipatt ) {
-      std::string userpattern = *uitr;
-      patterntext << "\n\t" << userpattern;
-
-      std::vector<std::string>::const_iterator ditr = dirs.begin();
-      for ( ; ditr != dirs.end(); ++ditr ) {
-        std::string dalt = *ditr;
-        // if non-null, does it end with a "/"?  if not add one
-        size_t len = dalt.size();
-        if ( len > 0 && dalt.rfind('/') != len-1 ) dalt.append("/");
-        if ( uitr == fFluxFilePatterns.begin() ) dirstext << "\n\t" << dalt;
-
-        std::string filepatt = dalt + userpattern;
-
-        glob(filepatt.c_str(),flags,NULL,&g);
-        if ( g.gl_pathc > 0 ) flags |= GLOB_APPEND; // next glob() will append to list
+    for ( ; uitr != fFluxFilePatterns.end(); ++uitr ) {
+      patterntext << "\n\t" << *uitr;
+    }
 
-      }  // loop over FluxSearchPaths dirs
-    }  // loop over user patterns
+    // glob each pattern in each dir (~ home directories expanded);
+    // sizes are only needed when paring down the list
+    evgb::FluxFileLister lister(fFluxGlobThreads,fFluxGlobCacheDir,fFluxGlobCacheTTL);
+    evgb::FluxFileLister::FileList_t flist =
+      lister.List(dirs,fFluxFilePatterns,randomizeFiles);
 
     std::ostringstream paretext;
     std::ostringstream flisttext;
 
-    int nfiles = g.gl_pathc;
+    int nfiles = flist.size();
 
     if ( nfiles == 0 ) {
       paretext << "\n  expansion resulted in a null list for flux files";
@@ -2017,7 +2753,7 @@ namespace evgb {
 
       paretext << "\n  list of files will be processed in order";
       for (int i=0; i<nfiles; ++i) {
-        std::string afile(g.gl_pathv[i]);
+        std::string afile(flist[i].first);
         fSelectedFluxFiles.push_back(afile);
 
         flisttext << "[" << setw(3) << i << "] "
@@ -2044,14 +2780,12 @@ namespace evgb {
       long long int sumBytes = 0; // accumulated size in bytes
       long long int maxBytes = (long long int)fMaxFluxFileMB * 1024ll * 1024ll;
 
-      FileStat_t fstat;
       for (int i=0; i < TMath::Min(nfiles,fMaxFluxFileNumber); ++i) {
         int indx = indices[i];
-        std::string afile(g.gl_pathv[indx]);
+        std::string afile(flist[indx].first);
         bool keep = true;
 
-        gSystem->GetPathInfo(afile.c_str(),fstat);
-        sumBytes += fstat.fSize;
+        sumBytes += TMath::Max(flist[indx].second,0L);
         // skip those that would push sum above total
         // but always accept at least one (the first)
         if ( sumBytes > maxBytes && i != 0 ) keep = false;
@@ -2080,9 +2814,6 @@ namespace evgb {
 
     mf::LogDebug("GENIEHelper") << "\n" << flisttext.str();
 
-    // done with glob list
-    globfree(&g);
-
     // no null path allowed for at least these
     if ( fFluxType.find("tree_") == 0 ) {
       size_t nfiles = fSelectedFluxFiles.size();
@@ -2164,6 +2895,9 @@ namespace evgb {
     std::ostringstream localtext;    // for info on local files
     fulltext << "search paths: " << spaths;
 
+    // a manifest (if readable from here) saves asking for the listing
+    bool fromManifest = SelectFluxFilesFromManifest(selectedlist);
+
     //std::vector<std::string>::const_iterator uitr = fFluxFilePatterns.begin();
 
     // loop over possible patterns
@@ -2174,6 +2908,7 @@ namespace evgb {
       std::string userpattern = *uitr;
       patterntext << "\npattern [" << std::setw(3) << ipatt << "] " << userpattern;
       fulltext    << "\npattern [" << std::setw(3) << ipatt << "] " << userpattern;
+      if ( fromManifest ) continue;
 
   #ifdef USE_IFDH_SERVICE
       partiallist = ifdhp->findMatchingFiles(spaths,userpattern);
@@ -2198,7 +2933,9 @@ namespace evgb {
     mf::LogDebug("GENIEHelper")
       << fulltext.str();
 
-    if ( nfiles == 0 ) {
+    if ( fromManifest ) {
+      selectedtext << "\n  " << selectedlist.size() << " files selected via FluxManifest";
+    } else if ( nfiles == 0 ) {
       selectedtext << "\n  expansion resulted in a null list for flux files";
     } else if ( ! randomizeFiles ) {
       // some sets of files should be left in order
@@ -2258,25 +2995,47 @@ namespace evgb {
 
     // have a selected list of remote files
     // get paths to local copies
+    // ifdh (and the art service holding it) stays on this thread, so the
+    // background copies are plain ones and need files readable from here
+    bool stageAsync = ( fFluxStageAsync && ! selectedlist.empty() );
+    if ( stageAsync ) {
+      for ( auto const& p : selectedlist ) {
+        if ( access(p.first.c_str(),R_OK) != 0 ) {
+          mf::LogWarning("GENIEHelper")
+            << "FluxStageAsync: " << p.first << " isn't readable as a plain file,"
+            << " fetching all the flux files with ifdh now";
+          stageAsync = false;
+          break;
+        }
+      }
+    }
+    if ( stageAsync ) {
+      // one file at a time in the background, collected by FinishFluxStaging()
+      fFluxStager = new evgb::FluxFileStager(selectedlist,
+                                             evgb::FluxFileStager::CopyToDir(fFluxStageDir));
+      fFluxOwnCopies = true;
+      fFluxStager->Start();
+    } else {
   #ifdef USE_IFDH_SERVICE
-    locallist = ifdhp->fetchSharedFiles(selectedlist,fFluxCopyMethod);
+      locallist = ifdhp->fetchSharedFiles(selectedlist,fFluxCopyMethod);
   #else
-    locallist = fIFDH->fetchSharedFiles(selectedlist,fFluxCopyMethod);
+      locallist = fIFDH->fetchSharedFiles(selectedlist,fFluxCopyMethod);
   #endif
 
-    localtext << "final list of files:";
-    size_t i=0;
-    for (auto litr = locallist.begin(); litr != locallist.end(); ++litr, ++i) {
-        fSelectedFluxFiles.push_back(litr->first);
-        localtext << "\n\t[" << std::setw(3) << i << "]\t" << litr->first;
-      }
+      localtext << "final list of files:";
+      size_t i=0;
+      for (auto litr = locallist.begin(); litr != locallist.end(); ++litr, ++i) {
+          fSelectedFluxFiles.push_back(litr->first);
+          localtext << "\n\t[" << std::setw(3) << i << "]\t" << litr->first;
+        }
 
-    mf::LogInfo("GENIEHelper")
-      << localtext.str();
+      mf::LogInfo("GENIEHelper")
+        << localtext.str();
+    }
 
     // no null path allowed for at least these
     if ( fFluxType.find("tree_") == 0 ) {
-      size_t nfiles = fSelectedFluxFiles.size();
+      size_t nfiles = ( fFluxStager ) ? selectedlist.size() : fSelectedFluxFiles.size();
       if ( nfiles == 0 ) {
         mf::LogError("GENIEHelper")
           << "For \"" << fFluxType <<"\" "
@@ -2296,6 +3055,212 @@ namespace evgb {
 #endif  // 'else' code only if NO_IFDH_LIB not defined
   } // ExpandFluxFilePatternsIFDH
 
+  //---------------------------------------------------------
+  bool GENIEHelper::SelectFluxFilesFromManifest(std::vector<std::pair<std::string,long>>& selected)
+  {
+    // Select tree_ flux files from the manifest(s) found in the
+    // FluxSearchPaths directories rather than from a listing: no glob,
+    // no stat of each file.  Files are chosen in the same randomized
+    // order as ExpandFluxFilePatternsDirect/IFDH, subject to the same
+    // size/number limits, and stop once fTargetPOT is reached.
+    // Returns false (caller lists the files) if there's no usable manifest.
+
+    if ( fFluxType.find("tree_") != 0 ) return false;
+    if ( fFluxManifest == "" ) {
+      if ( fTargetPOT > 0 )
+        mf::LogWarning("GENIEHelper") << "TargetPOT is only used with a FluxManifest; ignored";
+      return false;
+    }
+
+    // fnmatch() doesn't know about "~", so expand it up front
+    std::vector<std::string> dirs;
+    cet::split_path(fFluxSearchPaths,dirs);
+    if ( dirs.empty() ) dirs.push_back(std::string());
+    for ( auto& dalt : dirs ) {
+      dalt = ExpandTilde(dalt);
+      size_t len = dalt.size();
+      if ( len > 0 && dalt.rfind('/') != len-1 ) dalt.append("/");
+    }
+
+    evgb::FluxManifest manifest;
+    std::string manifestname = ExpandTilde(fFluxManifest);
+    if ( manifestname[0] == '/' ) {
+      manifest.Read(manifestname);
+    } else {
+      for ( auto const& dalt : dirs ) manifest.Read(dalt + manifestname);
+    }
+
+    // entries matching any of the user patterns in any of the dirs
+    std::vector<evgb::FluxManifestEntry const*> candidates;
+    size_t nwrongflavor = 0;
+    for ( auto const& entry : manifest.Entries() ) {
+      bool match = false;
+      for ( auto const& userpattern : fFluxFilePatterns ) {
+        for ( auto const& dalt : dirs ) {
+          std::string filepatt = ExpandTilde(dalt + userpattern);
+          match = match ||
+            ( fnmatch(filepatt.c_str(),entry.file.c_str(),FNM_PATHNAME) == 0 );
+        }
+      }
+      if ( ! match ) continue;
+      if ( ! entry.HasAnyFlavor(fGenFlavors) ) { ++nwrongflavor; continue; }
+      candidates.push_back(&entry);
+    }
+
+    int nfiles = candidates.size();
+    if ( nfiles == 0 ) {
+      if ( manifestname[0] == '/' || ! manifest.Entries().empty() ) {
+        mf::LogWarning("GENIEHelper")
+          << "FluxManifest \"" << fFluxManifest << "\" had no usable entries for the "
+          << "FluxFiles patterns (" << nwrongflavor << " lacked GenFlavors); "
+          << "falling back to listing the files";
+      }
+      return false;
+    }
+
+    std::vector<double> order(nfiles);
+    std::vector<int>    indices(nfiles);
+    fHelperRandom->RndmArray(nfiles,order.data());
+    TMath::Sort((int)nfiles,order.data(),indices.data(),false);
+
+    long long int sumBytes = 0;
+    long long int maxBytes = (long long int)fMaxFluxFileMB * 1024ll * 1024ll;
+    double        sumPOT   = 0;
+    long int      sumEntries = 0;
+    bool          potKnown = true;
+    std::ostringstream flisttext;
+
+    for (int i=0; i < TMath::Min(nfiles,fMaxFluxFileNumber); ++i) {
+      if ( fTargetPOT > 0 && sumPOT >= fTargetPOT ) break;
+      evgb::FluxManifestEntry const& entry = *candidates[indices[i]];
+      sumBytes += entry.bytes;
+      // always accept at least one (the first)
+      if ( sumBytes > maxBytes && i != 0 ) break;
+      sumPOT     += entry.pot;
+      sumEntries += entry.entries;
+      if ( entry.pot <= 0 ) potKnown = false;
+      selected.push_back(std::make_pair(entry.file,entry.bytes));
+      flisttext << "\n[" << setw(3) << i << "] "
+                << std::setw(6) << (sumBytes/(1024ll*1024ll)) << " MB "
+                << std::setw(12) << sumPOT << " POT "
+                << entry.file;
+    }
+
+    mf::LogInfo("GENIEHelper")
+      << "FluxManifest: " << nfiles << " matching files ("
+      << nwrongflavor << " more lacked GenFlavors), selected "
+      << selected.size() << " with " << sumEntries << " entries, "
+      << sumPOT << ( potKnown ? "" : " (incomplete)" ) << " POT, "
+      << (sumBytes/(1024ll*1024ll)) << " MB";
+    mf::LogDebug("GENIEHelper") << flisttext.str();
+
+    if ( fTargetPOT > 0 && sumPOT < fTargetPOT ) {
+      mf::LogWarning("GENIEHelper")
+        << "FluxManifest: selected files hold " << sumPOT << " POT, short of TargetPOT "
+        << fTargetPOT << " (limited by MaxFluxFileMB/MaxFluxFileNumber or unknown POT)";
+    }
+
+    return true;
+  }
+
+  //---------------------------------------------------------
+  bool GENIEHelper::UseProjectedFlux(std::string const& xmlbase)
+  {
+    // Swap the selected dk2nu files for their columnar versions already
+    // projected to fDetLocation (make_columnar_flux -d), if every one of
+    // them is in fProjectedFluxDir; the per-ray decay kinematics is then
+    // skipped entirely.  All or nothing, so the exposure stays consistent.
+
+    if ( fProjectedFluxDir == "" || fSelectedFluxFiles.empty() ) return false;
+
+    std::string key = genie::flux::GColumnarFlux::ProjectionKey(fDetLocation,xmlbase);
+    std::vector<std::string> projected;
+    std::ostringstream missing;
+    size_t nmissing = 0;
+    for ( auto const& ff : fSelectedFluxFiles ) {
+      std::string pf =
+        genie::flux::GColumnarFlux::ProjectedFileName(fProjectedFluxDir,ff,key);
+      if ( access(pf.c_str(),R_OK) == 0 ) {
+        projected.push_back(pf);
+      } else {
+        missing << "\n  " << pf;
+        ++nmissing;
+      }
+    }
+
+    if ( nmissing > 0 ) {
+      // asked for, but not usable: worth noticing, the job runs slower
+      mf::LogWarning("GENIEHelper")
+        << "ProjectedFluxDir: " << nmissing << " of " << fSelectedFluxFiles.size()
+        << " dk2nu files have no projection for \"" << fDetLocation << "\" (" << key
+        << "), using the dk2nu files; missing:" << missing.str();
+      return false;
+    }
+
+    mf::LogInfo("GENIEHelper")
+      << "ProjectedFluxDir: using " << projected.size() << " files projected for \""
+      << fDetLocation << "\" (" << key << ") from " << fProjectedFluxDir
+      << "; no dk2nu/NuChoice objects are available for these";
+    fSelectedFluxFiles.swap(projected);
+    fFluxType = "tree_columnar";
+    return true;
+  }
+
+  //---------------------------------------------------------
+  void GENIEHelper::ExpandFluxFilePatternsCopy()
+  {
+    // select the files just as for DIRECT access, then copy them
+    // to fFluxStageDir (in the background if so configured)
+    ExpandFluxFilePatternsDirect();
+
+    evgb::FluxFileStager::FileList_t remotelist;
+    FileStat_t fstat;
+    for ( auto const& ff : fSelectedFluxFiles ) {
+      gSystem->GetPathInfo(ff.c_str(),fstat);
+      remotelist.push_back(std::make_pair(ff,(long)fstat.fSize));
+    }
+    fSelectedFluxFiles.clear();
+    if ( remotelist.empty() ) return;
+
+    fFluxStager = new evgb::FluxFileStager(remotelist,
+                                           evgb::FluxFileStager::CopyToDir(fFluxStageDir));
+    fFluxOwnCopies = true;
+    fFluxStager->Start();
+    if ( ! fFluxStageAsync ) FinishFluxStaging();
+  }
+
+  //---------------------------------------------------------
+  void GENIEHelper::FinishFluxStaging()
+  {
+    if ( ! fFluxStager ) return;
+
+    size_t nrequested = fFluxStager->NFiles();
+    std::vector<std::string> locallist = fFluxStager->WaitAll();
+
+    std::ostringstream localtext;
+    localtext << "final list of files"
+              << " (staged in " << fFluxStager->StageSeconds() << " s,"
+              << " waited " << fFluxStager->WaitSeconds() << " s):";
+    for ( size_t i = 0; i < locallist.size(); ++i ) {
+      fSelectedFluxFiles.push_back(locallist[i]);
+      localtext << "\n\t[" << std::setw(3) << i << "]\t" << locallist[i];
+    }
+    mf::LogInfo("GENIEHelper") << localtext.str();
+
+    delete fFluxStager;
+    fFluxStager = 0;
+
+    if ( locallist.size() != nrequested ) {
+      mf::LogWarning("GENIEHelper")
+        << "only " << locallist.size() << " of " << nrequested
+        << " flux files could be staged";
+    }
+    if ( fFluxType.find("tree_") == 0 && fSelectedFluxFiles.empty() ) {
+      throw cet::exception("NoFluxFiles")
+        << "none of the " << nrequested << " flux files could be staged";
+    }
+  }
+
   //---------------------------------------------------------
   void GENIEHelper::SetGXMLPATH()
   {
@@ -2522,19 +3487,72 @@ namespace evgb {
     mf::LogInfo("GENIEHelper")
       << "XSecTable/GSPLOAD full path \"" << fXSecTable << "\"";
 
+    // only the splines this job can use
+    std::set<int> splineTargets, splineProbes;
+    bool filterSplines =
+      fXSecFilterSplines && SplineSelection(splineTargets,splineProbes);
+    std::ostringstream selection;
+    if ( filterSplines ) {
+      selection << "tgt:";
+      for ( int pdg : splineTargets ) selection << pdg << ",";
+      selection << ";nu:";
+      for ( int pdg : splineProbes  ) selection << pdg << ",";
+      mf::LogInfo("GENIEHelper") << "reading only splines for " << selection.str();
+    }
+
     TStopwatch xtime;
     xtime.Start();
 
+    auto filter = [&](std::string const& name) {
+      int pdg;
+      if ( evgb::XSecSplineCache::KeyPdg(name,"nu",pdg) &&
+           ! splineProbes.count(pdg)  ) return false;
+      if ( evgb::XSecSplineCache::KeyPdg(name,"tgt",pdg) &&
+           ! splineTargets.count(pdg) ) return false;
+      return true;
+    };
+
+    // a node-local, compacted copy is quicker to read than the original;
+    // anything wrong with it and we quietly use the original.
+    // Without a cache directory a filtered copy is made just for this job.
+    std::string xsecLoadPath = fXSecTable;
+    std::string jobSplineDir;
+    if ( fXSecCacheDir != "" || filterSplines ) {
+      std::string cacheDir = fXSecCacheDir;
+      if ( cacheDir == "" ) {
+        const char* tmpdir = std::getenv("TMPDIR");
+        jobSplineDir = std::string( ( tmpdir ) ? tmpdir : "/tmp" ) +
+          "/evgb-gxspl-" + std::to_string(getpid());
+        cacheDir = jobSplineDir;
+      }
+      evgb::XSecSplineCache xsecCache(cacheDir);
+      std::string key = xsecCache.MakeKey(fXSecTable,fTuneName,fEventGeneratorList,
+                                          std::string(__GENIE_RELEASE__) + " " +
+                                          selection.str());
+      std::string cached = xsecCache.Lookup(key);
+      if ( cached == "" ) {
+        if ( filterSplines ) cached = xsecCache.Build(key,fXSecTable,filter);
+        else                 cached = xsecCache.Build(key,fXSecTable);
+      }
+      if ( cached != "" ) xsecLoadPath = cached;
+    }
+
     // can't use gSystem->Unsetenv() as it is really gSystem->Setenv(name,"")
     unsetenv("GSPLOAD");  // MUST!!! ensure that it isn't set externally
-    genie::utils::app_init::XSecTable(fXSecTable,true);
+    genie::utils::app_init::XSecTable(xsecLoadPath,true);
+
+    if ( jobSplineDir != "" ) {
+      if ( xsecLoadPath != fXSecTable ) std::remove(xsecLoadPath.c_str());
+      rmdir(jobSplineDir.c_str());
+    }
 
     xtime.Stop();
+    fStats.xsecLoadSeconds = xtime.RealTime();
     mf::LogInfo("GENIEHelper")
       << "Time to read GENIE XSecTable: "
       << " Real " << xtime.RealTime() << " s,"
       << " CPU " << xtime.CpuTime() << " s"
-      << " from " << fXSecTable;
+      << " from " << xsecLoadPath;
 
   }
 
@@ -10,6 +10,11 @@
 
 #include <vector>
 #include <set>
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+#include "nugen/EventGeneratorBase/GENIE/GENIEHelperStats.h"
 
 
 // GENIE
@@ -17,6 +22,14 @@ namespace genie {
   class GFluxI;
   class GeomAnalyzerI;
   class GMCJDriver;
+  class PathLengthList;
+  namespace geometry {
+    class ROOTGeomAnalyzer;
+  }
+  namespace flux {
+    class GFluxExposureI;
+    class GFluxBlender;
+  }
 }
 
 // ROOT
@@ -26,6 +39,7 @@ class TF1;
 class TRandom3;
 class TRotation;
 class TGeoManager;
+class TGeoVolume;
 #include "TVector3.h"
 
 ///parameter set interface
@@ -50,6 +64,9 @@ namespace genie { class EventRecord; }
 namespace evgb {
 
   class EvtTimeShiftI;   // for shifting time within a spill
+  class FluxFileStager;
+  class GFluxReadAhead;
+  class GFluxEnergyWindow;
 
   class GENIEHelper {
 
@@ -67,6 +84,17 @@ namespace evgb {
                                   simb::MCFlux  &flux,
                                   simb::GTruth  &gtruth);
 
+    // generate up to n interactions (n == 0: the rest of the spill, i.e.
+    // until Stop() returns true), appending to the vectors; per-call setup
+    // is done once for the whole batch.  The optional callback is invoked
+    // with the index of each new entry while the flux driver still
+    // describes that entry.  Returns the number of entries added.
+    size_t                 SampleBatch(size_t n,
+                                       std::vector<simb::MCTruth> &truths,
+                                       std::vector<simb::MCFlux>  &fluxes,
+                                       std::vector<simb::GTruth>  &gtruths,
+                                       std::function<void(size_t)> const& onEvent = nullptr);
+
     double                 TotalHistFlux();
     double                 TotalExposure()    const { return fTotalExposure;  }
 
@@ -88,6 +116,8 @@ namespace evgb {
 
     // direct access to flux driver ... no ownership handover
     // base is the "real" flux driver, might be wrapped by a flavor mixer
+    // (with FluxReadAhead it is an evgb::GFluxReadAhead around the real one,
+    // with FluxEnergyWindow an evgb::GFluxEnergyWindow, in that order)
     genie::GFluxI*        GetFluxDriver(bool base = true )
       { return ( (base) ? fFluxD : fFluxD2GMCJD ); }
 
@@ -95,11 +125,15 @@ namespace evgb {
     std::string           GetTuneName()           const { return fTuneName; }
     std::string           GetEventGeneratorList() const { return fEventGeneratorList; }
 
+    // per-stage timing and counters so far (also written out at the end)
+    GENIEHelperStats      Stats() const;
+
   private:
 
     void RegularizeFluxType();
     void SqueezeFilePatterns();
     void AtmoFluxCheck();
+    void AtmoAutoRadii();       ///< set fAtmoRl, fAtmoRt from the top volume
     void HistogramFluxCheck();
 
     void InitializeGeometry();
@@ -108,13 +142,35 @@ namespace evgb {
     void InitializeFluxDriver();
     void ConfigGeomScan();
     void SetMaxPathOutInfo();
+    std::string MaxPathInfo() const;      ///< setup a GeomScan result is valid for
+    std::string MaxPathCacheKey() const;  ///< "" if the geometry can't be hashed
+    void WriteMaxPathLengths(std::string const& filename,
+                             std::string const& info) const;
+    void SaveMaxPathCache();
+    bool ParallelGeomScan(genie::geometry::ROOTGeomAnalyzer* rgeom,
+                          int npoints, int nrays, int nparticles);
+    double ExposureProbScale() const;  ///< divides raw flux exposure
+    bool   SplineSelection(std::set<int>& targets, std::set<int>& probes) const;
 
     void BuildFluxRotation();
     void ExpandFluxPaths();
     void ExpandFluxFilePatternsDirect();
     void ExpandFluxFilePatternsIFDH();
+    void ExpandFluxFilePatternsCopy();
+    bool SelectFluxFilesFromManifest(std::vector<std::pair<std::string,long>>& selected);
+    bool UseProjectedFlux(std::string const& xmlbase);  ///< tree_dk2nu -> projected tree_columnar
+    void FinishFluxStaging();     ///< wait for background copies, fill fSelectedFluxFiles
     bool StringToBool(std::string v);
 
+    // Sample() == GenerateRecord() + FillTruthRecords(); the first half
+    // uses GENIE's singletons and the shared geometry, the second only
+    // this helper's own event record and flux driver
+    bool GenerateRecord(simb::MCFlux &flux);
+    bool GenerateRecordInTopVolume(simb::MCFlux &flux); ///< top volume already set
+    void FillTruthRecords(simb::MCTruth &truth,
+                          simb::MCFlux  &flux,
+                          simb::GTruth  &gtruth);
+
     void SetGXMLPATH();
     void SetGMSGLAYOUT();
     void StartGENIEMessenger(std::string prodmode);
@@ -125,10 +181,19 @@ namespace evgb {
 
     genie::EventRecord*      fGenieEventRecord;  ///< last generated event
     genie::GeomAnalyzerI*    fGeomD;
-    genie::GFluxI*           fFluxD;             ///< real flux driver
+    genie::GFluxI*           fFluxD;             ///< real flux driver, or GFluxReadAhead/GFluxEnergyWindow around it
     genie::GFluxI*           fFluxD2GMCJD;       ///< flux driver passed to genie GMCJDriver, might be GFluxBlender
     genie::GMCJDriver*       fDriver;
 
+    // looked up once in Initialize() rather than for every event
+    TGeoVolume*              fTopVol;            ///< fTopVolume in fGeoManager
+    TGeoVolume*              fWorldVol;          ///< fWorldVolume in fGeoManager
+    genie::flux::GFluxExposureI* fFluxExposureI; ///< fFluxD, if it tracks exposure
+    genie::flux::GFluxBlender*   fFluxBlender;   ///< fFluxD2GMCJD, if flavors are mixed
+    evgb::GFluxReadAhead*        fFluxReadAheadD;///< fFluxD, if rays are read ahead
+    evgb::GFluxEnergyWindow*     fFluxWindowD;   ///< fFluxD (or the one read ahead), if rays are cut on energy
+    std::unordered_map<std::string, std::string> fGenConfig; ///< generator info for MCTruth
+
     // for now leave this here ... but not necessary when using IFDH_service
     ifdh_ns::ifdh*           fIFDH;              ///< (optional) flux file handling
 
@@ -146,6 +211,18 @@ namespace evgb {
     int                      fMaxFluxFileNumber; ///< maximum # of flux files
     std::string              fFluxCopyMethod;    ///< "DIRECT" = old direct access method, otherwise = ifdh approach schema ("" okay)
     std::string              fFluxCleanup;       ///< "ALWAYS", "/var/tmp", "NEVER"
+    bool                     fFluxStageAsync;    ///< copy flux files in the background (tree_ fluxes)
+    std::string              fFluxStageDir;      ///< where FluxCopyMethod "COPY" (or async IFDH) puts the files
+    evgb::FluxFileStager*    fFluxStager;        ///< copies in progress (if any)
+    bool                     fFluxOwnCopies;     ///< fSelectedFluxFiles are our own copies, not ifdh's
+    std::string              fFluxManifest;      ///< manifest name in each search path ("" = list the files)
+    double                   fTargetPOT;         ///< select manifest files until this POT is reached (0 = no limit)
+    int                      fFluxGlobThreads;   ///< threads for glob/stat of DIRECT/COPY patterns
+    std::string              fFluxGlobCacheDir;  ///< where to keep expanded file lists ("" = don't)
+    double                   fFluxGlobCacheTTL;  ///< seconds a cached file list stays valid
+    std::string              fProjectedFluxDir;  ///< dk2nu files already projected to fDetLocation
+    int                      fFluxReadAhead;     ///< rays to read ahead on a background thread (tree_ fluxes, 0 = off)
+    std::vector<double>      fFluxEnergyWindow;  ///< [emin,emax] GeV, tree_ flux rays outside are dropped (empty = all)
     std::string              fBeamName;          ///< name of the beam we are simulating
     std::string              fFluxRotCfg;        ///< how to interpret fFluxRotValues
     std::vector<double>      fFluxRotValues;     ///< parameters for rotation
@@ -157,6 +234,7 @@ namespace evgb {
     std::vector<TH1D *>      fFluxHistograms;    ///< histograms for each nu species
 
     double                   fFluxUpstreamZ;     ///< z where flux starts from (if non-default, simple/ntuple only)
+    int                      fFluxEntryReuse;    ///< times each tree_ flux entry is used before reading the next
     double                   fEventsPerSpill;    ///< number of events to generate in each spill if not using POT/spill.
                                                  ///< If using Atmo, set to 1
     double                   fPOTPerSpill;       ///< number of pot per spill
@@ -167,6 +245,7 @@ namespace evgb {
     double                   fMonoEnergy;        ///< energy of monoenergetic neutrinos
     std::string              fFunctionalFlux;
     int                      fFunctionalBinning;
+    bool                     fFluxAliasTable;    ///< histogram/function fluxes: GAliasTableFlux rather than GCylindTH1Flux
     double                   fEmin;
     double                   fEmax;
     double                   fXSecMassPOT;       ///< product of cross section, mass and POT/spill for histogram fluxes
@@ -182,6 +261,7 @@ namespace evgb {
     std::string              fSpillTimeConfig;   ///< alternative to flat spill distribution
     bool                     fAddGenieVtxTime;   ///< incorporate time from flux window to interaction point and (possibily) proton-on-target to flux window
     bool                     fForceApplyFlxWgt;  ///< apply GFluxI::Weight() before returning event
+    bool                     fForceInteraction;  ///< every ray interacts, weight = interaction probability
 
     std::vector<int>         fGenFlavors;        ///< pdg codes for flavors to generate
     double                   fAtmoEmin;          ///< atmo: Minimum energy of neutrinos in GeV
@@ -190,9 +270,18 @@ namespace evgb {
     double                   fAtmoRt;            ///< atmo: radius of the transvere (perpendicular) area on the sphere
                                                  ///< where the neutrinos are generated
     double                   fAtmoSpectralIndex; ///< atmo: Spectral index for power spectrum generation
+    bool                     fAtmoImportance;    ///< atmo: PowerSpectrum samples from the flux tables
+    bool                     fAtmoQuasiRandom;   ///< atmo: PowerSpectrum draws from a Sobol sequence
+    int                      fAtmoQuasiOffset;   ///< atmo: first Sobol point of this job
+    int                      fAtmoQuasiScramble; ///< atmo: Sobol scramble seed, 0 = from the job's seed
+    bool                     fAtmoQuasiClaimed;  ///< atmo: holds its (scramble, offset) in this process
+    bool                     fAtmoAutoRadii;     ///< atmo: Rl, Rt from the top volume's bounding sphere
+    double                   fAtmoRadiusMargin;  ///< atmo: added to the automatic radii (m)
     
     std::vector<std::string> fEnvironment;       ///< environmental variables and settings used by genie
     std::string              fXSecTable;         ///< cross section file (was $GSPLOAD)
+    std::string              fXSecCacheDir;      ///< node-local cache of spline files ("" = none)
+    bool                     fXSecFilterSplines; ///< read only splines for the geometry's nuclei & fGenFlavors
     std::string              fTuneName;          ///< GENIE R-3 Tune name (defines model configuration)
     std::string              fEventGeneratorList;///< control over event topologies, was $GEVGL [Default]
     std::string              fGXMLPATH;          ///< locations for GENIE XML files
@@ -205,7 +294,17 @@ namespace evgb {
     std::string              fFiducialCut;       ///< configuration for geometry selector
     std::string              fGeomScan;          ///< configuration for geometry scan to determine max pathlengths
     std::string              fMaxPathOutInfo;    ///< output info if writing PathLengthList from GeomScan
+    std::string              fMaxPathCacheDir;   ///< directory of saved GeomScan results ("" = none)
+    std::string              fMaxPathCacheFile;  ///< where to save this job's scan (if it wasn't cached)
+    int                      fGeomScanThreads;   ///< threads for GeomScan (0 = GENIE's serial scan, <0 = all cores)
+    genie::PathLengthList*   fScannedMaxPath;    ///< result of ParallelGeomScan (if used)
+    std::string              fScanXmlFile;       ///< ... as handed to GMCJDriver
     unsigned int             fDebugFlags;        ///< set bits to enable debug info
+
+    GENIEHelperStats         fStats;             ///< per-stage timing and counters
+    std::string              fStatsFile;         ///< if set, also write the stats (JSON) here at the end
+    static constexpr int     kNoFluxRun = -999999;
+    int                      fLastFluxRun;       ///< MCFlux::frun of the previous record
   };
 }
 #endif //EVGB_GENIEHELPER_H
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GENIEHelperStats.cxx
+/// \brief Per-stage timing and counters accumulated by GENIEHelper
+///
+////////////////////////////////////////////////////////////////////////
+
+#include "nugen/EventGeneratorBase/GENIE/GENIEHelperStats.h"
+
+namespace {
+
+  void WriteStage(std::ostream& os, const char* name,
+                  evgb::GENIEHelperStats::Stage const& stage, bool last = false)
+  {
+    os << "    \"" << name << "\": { \"calls\": " << stage.calls
+       << ", \"seconds\": " << stage.seconds
+       << ", \"mean_us\": " << stage.MeanMicroSec() << " }"
+       << ( last ? "" : "," ) << "\n";
+  }
+
+}
+
+namespace evgb {
+
+  //--------------------------------------------------
+  void GENIEHelperStats::WriteJSON(std::ostream& os, std::string const& fluxType) const
+  {
+    std::ios_base::fmtflags oldflags = os.flags();
+    std::streamsize         oldprec  = os.precision(9);
+
+    os << "{\n"
+       << "  \"flux_type\": \"" << fluxType << "\",\n"
+       << "  \"spills\": " << nSpills << ",\n"
+       << "  \"records\": " << nRecords << ",\n"
+       << "  \"null_records\": " << nNullRecords << ",\n"
+       << "  \"flux_rays\": " << nFluxRays << ",\n"
+       << "  \"flux_file_switches\": " << nFluxFileSwitches << ",\n"
+       << "  \"xsec_load_seconds\": " << xsecLoadSeconds << ",\n"
+       << "  \"stages\": {\n";
+    WriteStage(os,"GenerateEvent",generateEvent);
+    WriteStage(os,"FillMCFlux",fillMCFlux);
+    WriteStage(os,"FillMCTruth",fillMCTruth);
+    WriteStage(os,"FillGTruth",fillGTruth);
+    WriteStage(os,"TimeShifter",timeShifter,true);
+    os << "  }\n"
+       << "}\n";
+
+    os.flags(oldflags);
+    os.precision(oldprec);
+  }
+
+} // namespace evgb
@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GENIEHelperStats.h
+/// \class evgb::GENIEHelperStats
+/// \brief Per-stage timing and counters accumulated by GENIEHelper
+///
+///        Filled as GENIEHelper generates events; see GENIEHelper::Stats().
+///        WriteJSON() gives a machine readable summary (one object).
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_GENIEHELPERSTATS_H
+#define EVGB_GENIEHELPERSTATS_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace evgb {
+
+  struct GENIEHelperStats {
+
+    /// accumulated wall clock time for one stage
+    struct Stage {
+      long int calls   = 0;
+      double   seconds = 0;
+      void     Add(std::chrono::steady_clock::duration dt)
+        { ++calls; seconds += std::chrono::duration<double>(dt).count(); }
+      double   MeanMicroSec() const
+        { return ( calls > 0 ) ? 1.0e6*seconds/calls : 0; }
+    };
+
+    Stage    generateEvent;          ///< GMCJDriver::GenerateEvent()
+    Stage    fillMCFlux;             ///< evgb::FillMCFlux()
+    Stage    fillMCTruth;            ///< evgb::FillMCTruth()
+    Stage    fillGTruth;             ///< evgb::FillGTruth()
+    Stage    timeShifter;            ///< picking the time offset within the spill
+
+    double   xsecLoadSeconds   = 0;  ///< reading the XSecTable (if this helper did)
+    long int nRecords          = 0;  ///< GenerateEvent() calls
+    long int nNullRecords      = 0;  ///< ... of which returned no record
+    long int nSpills           = 0;  ///< spills completed (Stop() returned true)
+    long int nFluxRays         = -1; ///< rays thrown by the flux driver (-1 = driver can't say)
+    long int nFluxFileSwitches = 0;  ///< changes of MCFlux::frun (i.e. flux file/job) between records
+
+    void WriteJSON(std::ostream& os, std::string const& fluxType = "") const;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_GENIEHELPERSTATS_H
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "TRandom3.h"
+
+#include "nugen/EventGeneratorBase/GENIE/GFlavorMixerTable.h"
+#include "GENIE/Tools/Flux/GFlavorMap.h"
+#include "GENIE/Tools/Flux/GFlavorMixerFactory.h"
+#include "GENIE/Framework/Messenger/Messenger.h"
+
+FLAVORMIXERREG4(genie,flux,GFlavorMixerTable,genie::flux::GFlavorMixerTable)
+
+using namespace genie;
+using namespace genie::flux;
+
+namespace {
+	const size_t kNInitial = 6; ///< the first six of FinalFlavors()
+	const double kMaxTableError = 1.0e-3; ///< warn if the table is further off the mixer
+
+	std::string Trim(const std::string& s)
+	{
+		size_t first = s.find_first_not_of(" \t\n");
+		if ( first == std::string::npos ) return "";
+		size_t last = s.find_last_not_of(" \t\n");
+		return s.substr(first,last-first+1);
+	}
+}
+
+GFlavorMixerTable::GFlavorMixerTable()
+  : fMixer(0)
+  , fLogEMin(0)
+  , fDLogE(0)
+  , fNE(0)
+  , fLMin(0)
+  , fDL(0)
+  , fNL(0)
+  , fTable(kNInitial)
+  , fRowInit(0)
+  , fRowE(-1)
+  , fRowL(-1)
+  , fRow(FinalFlavors().size(),0.)
+{
+
+}
+
+//________________________________________________________________________________________
+
+GFlavorMixerTable::~GFlavorMixerTable()
+{
+	delete fMixer;
+}
+
+//________________________________________________________________________________________
+
+const std::vector<int>& GFlavorMixerTable::FinalFlavors(void)
+{
+	static const std::vector<int> flavors = { 12, -12, 14, -14, 16, -16, 0 };
+	return flavors;
+}
+
+//________________________________________________________________________________________
+
+int GFlavorMixerTable::FinalIndex(int pdg)
+{
+	const std::vector<int>& flavors = FinalFlavors();
+	std::vector<int>::const_iterator itr = std::find(flavors.begin(),flavors.end(),pdg);
+	return ( itr == flavors.end() ) ? -1 : itr - flavors.begin();
+}
+
+//________________________________________________________________________________________
+
+int GFlavorMixerTable::InitialIndex(int pdg)
+{
+	int indx = FinalIndex(pdg);
+	return ( indx < (int)kNInitial ) ? indx : -1;
+}
+
+//________________________________________________________________________________________
+
+void GFlavorMixerTable::Config(std::string config)
+{
+	size_t bar = config.find('|');
+	std::string grid  = config.substr(0,bar);
+	std::string mixer = ( bar == std::string::npos ) ? "" : Trim(config.substr(bar+1));
+
+	// grid: E=emin,emax,ne  L=lmin,lmax,nl  or  L=dist
+	std::istringstream gridtokens(grid);
+	std::string token;
+	while ( gridtokens >> token ) {
+		size_t eq = token.find('=');
+		std::string key = token.substr(0,eq);
+		std::string values = ( eq == std::string::npos ) ? "" : token.substr(eq+1);
+		std::replace(values.begin(),values.end(),',',' ');
+		std::istringstream vals(values);
+		double vmin = 0, vmax = 0;
+		int n = 1;
+		vals >> vmin;
+		if ( ! ( vals >> vmax >> n ) ) { vmax = vmin; n = 1; }
+		if ( key == "E" && vmin > 0 && vmax > vmin && n > 1 ) {
+			fLogEMin = std::log(vmin);
+			fDLogE   = ( std::log(vmax) - fLogEMin ) / ( n - 1 );
+			fNE      = n;
+		} else if ( key == "L" && vmin >= 0 && ( n == 1 || ( vmax > vmin && n > 1 ) ) ) {
+			fLMin = vmin;
+			fDL   = ( n > 1 ) ? ( vmax - vmin ) / ( n - 1 ) : 0;
+			fNL   = n;
+		} else {
+			LOG("Flux", pERROR) << "GFlavorMixerTable: can't use \"" << token << "\"";
+		}
+	}
+	if ( fNE == 0 || fNL == 0 ) {
+		LOG("Flux", pWARN)
+		<< "GFlavorMixerTable: no E and L grid, every ray goes to the wrapped mixer";
+	}
+
+	// the wrapped mixer, made the way GENIEHelper would for MixerConfig
+	delete fMixer;
+	fMixer = 0;
+	std::string keyword = mixer.substr(0,mixer.find_first_of(" \t\n"));
+	if ( keyword == "map" || keyword == "swap" || keyword == "fixedfrac" ) {
+		fMixer = new GFlavorMap();
+		fMixer->Config(mixer);
+	} else if ( keyword != "" ) {
+		fMixer = GFlavorMixerFactory::Instance().GetFlavorMixer(keyword);
+		if ( fMixer ) fMixer->Config(Trim(mixer.substr(keyword.size())));
+	}
+	if ( ! fMixer ) {
+		LOG("Flux", pERROR)
+		<< "GFlavorMixerTable: no mixer for \"" << keyword << "\", flavors are left as they are";
+	}
+
+	for ( auto& table : fTable ) table.clear();
+	fRowE = -1;
+}
+
+//________________________________________________________________________________________
+
+void GFlavorMixerTable::FillTable(int iinit)
+{
+	const std::vector<int>& finals = FinalFlavors();
+	const size_t nfinal = finals.size();
+	int pdg_initial = finals[iinit];
+
+	std::vector<double>& table = fTable[iinit];
+	table.resize(size_t(fNL)*fNE*nfinal);
+	for ( int il = 0; il < fNL; ++il ) {
+		double dist = fLMin + il*fDL;
+		for ( int ie = 0; ie < fNE; ++ie ) {
+			double energy = std::exp(fLogEMin + ie*fDLogE);
+			double* cell = &table[(size_t(il)*fNE + ie)*nfinal];
+			for ( size_t ifin = 0; ifin < nfinal; ++ifin ) {
+				cell[ifin] = fMixer->Probability(pdg_initial,finals[ifin],energy,dist);
+			}
+		}
+	}
+
+	// compare with the wrapped mixer between the grid points
+	TRandom3 rnd(20261016);
+	std::vector<double> row(nfinal);
+	double maxdiff = 0;
+	const int ncheck = 1000;
+	for ( int icheck = 0; icheck < ncheck; ++icheck ) {
+		double x = (fNE-1)*rnd.Rndm();
+		double y = ( fNL > 1 ) ? (fNL-1)*rnd.Rndm() : 0;
+		double energy = std::exp(fLogEMin + x*fDLogE);
+		double dist   = fLMin + y*fDL;
+		this->Interpolate(iinit,x,y,row.data());
+		for ( size_t ifin = 0; ifin < nfinal; ++ifin ) {
+			double ref = fMixer->Probability(pdg_initial,finals[ifin],energy,dist);
+			maxdiff = std::max(maxdiff,std::fabs(row[ifin]-ref));
+		}
+	}
+
+	LOG("Flux", pINFO)
+	<< "GFlavorMixerTable: tabulated " << pdg_initial << " on "
+	<< fNE << " x " << fNL << " (E x L) points, largest difference to the mixer "
+	<< maxdiff;
+	if ( maxdiff > kMaxTableError ) {
+		LOG("Flux", pWARN)
+		<< "GFlavorMixerTable: probabilities for " << pdg_initial << " are off by up to "
+		<< maxdiff << " between the grid points; use a finer grid";
+	}
+}
+
+//________________________________________________________________________________________
+
+void GFlavorMixerTable::Interpolate(int iinit, double x, double y, double* row) const
+{
+	const size_t nfinal = FinalFlavors().size();
+	const std::vector<double>& table = fTable[iinit];
+
+	int ix = std::min(int(x),fNE-2);
+	double fx = x - ix;
+	int iy = ( fNL > 1 ) ? std::min(int(y),fNL-2) : 0;
+	double fy = ( fNL > 1 ) ? y - iy : 0;
+	const double* c00 = &table[(size_t(iy)*fNE + ix)*nfinal];
+	const double* c01 = c00 + nfinal;
+	const double* c10 = ( fNL > 1 ) ? c00 + size_t(fNE)*nfinal : c00;
+	const double* c11 = c10 + nfinal;
+	double total = 0, kept = 0;
+	for ( size_t ifin = 0; ifin < nfinal; ++ifin ) {
+		double p = (1.-fy) * ( (1.-fx)*c00[ifin] + fx*c01[ifin] )
+		         +     fy  * ( (1.-fx)*c10[ifin] + fx*c11[ifin] );
+		total    += p;
+		row[ifin] = std::min(1.,std::max(0.,p));
+		kept     += row[ifin];
+	}
+	// clamping moves the row's sum; scale back to the interpolated one
+	total = std::min(1.,std::max(0.,total));
+	if ( kept > 0 && kept != total ) {
+		for ( size_t ifin = 0; ifin < nfinal; ++ifin ) row[ifin] *= total/kept;
+	}
+}
+
+//________________________________________________________________________________________
+
+const double* GFlavorMixerTable::Probabilities(int pdg_initial, double energy, double dist)
+{
+	if ( pdg_initial == fRowInit && energy == fRowE && dist == fRowL ) return fRow.data();
+
+	const std::vector<int>& finals = FinalFlavors();
+	const size_t nfinal = finals.size();
+	fRowInit = pdg_initial;
+	fRowE    = energy;
+	fRowL    = dist;
+
+	int iinit = InitialIndex(pdg_initial);
+	if ( ! fMixer || iinit < 0 ) {
+		for ( size_t ifin = 0; ifin < nfinal; ++ifin ) {
+			fRow[ifin] = ( finals[ifin] == pdg_initial ) ? 1. : 0.;
+		}
+		return fRow.data();
+	}
+
+	// where on the grid?
+	bool ongrid = ( fNE > 1 && fNL > 0 && energy > 0 );
+	double x = 0, y = 0;
+	if ( ongrid ) {
+		x = ( std::log(energy) - fLogEMin ) / fDLogE;
+		ongrid = ( x >= 0 && x <= fNE-1 );
+	}
+	if ( ongrid && fNL > 1 ) {
+		y = ( dist - fLMin ) / fDL;
+		ongrid = ( y >= 0 && y <= fNL-1 );
+	} else if ( ongrid ) {
+		ongrid = ( std::fabs(dist-fLMin) <= 1.0e-6*std::max(1.,fLMin) );
+	}
+
+	if ( ! ongrid ) {
+		for ( size_t ifin = 0; ifin < nfinal; ++ifin ) {
+			fRow[ifin] = fMixer->Probability(pdg_initial,finals[ifin],energy,dist);
+		}
+		return fRow.data();
+	}
+
+	if ( fTable[iinit].empty() ) FillTable(iinit);
+	this->Interpolate(iinit,x,y,fRow.data());
+	return fRow.data();
+}
+
+//________________________________________________________________________________________
+
+double GFlavorMixerTable::Probability(int pdg_initial, int pdg_final,
+                                      double energy, double dist)
+{
+	int ifin = FinalIndex(pdg_final);
+	if ( ifin < 0 ) {
+		return ( fMixer ) ? fMixer->Probability(pdg_initial,pdg_final,energy,dist) : 0.;
+	}
+	return this->Probabilities(pdg_initial,energy,dist)[ifin];
+}
+
+//________________________________________________________________________________________
+
+void GFlavorMixerTable::PrintConfig(bool verbose)
+{
+	std::ostringstream s;
+	s << "GFlavorMixerTable: ";
+	if ( fNE > 1 && fNL > 0 ) {
+		s << fNE << " E points in [" << std::exp(fLogEMin) << ","
+		  << std::exp(fLogEMin+(fNE-1)*fDLogE) << "] GeV (log), ";
+		if ( fNL > 1 ) s << fNL << " L points in [" << fLMin << "," << fLMin+(fNL-1)*fDL << "] m";
+		else           s << "L = " << fLMin << " m";
+	} else {
+		s << "no grid";
+	}
+	LOG("Flux", pNOTICE) << s.str();
+	if ( fMixer ) fMixer->PrintConfig(verbose);
+}
@@ -0,0 +1,81 @@
+//____________________________________________________________________________
+/*!
+
+\class   genie::flux::GFlavorMixerTable
+
+\brief   A GFlavorMixerI that tabulates another mixer's probabilities on
+         an (E, L) grid (log spaced in E) for every initial/final flavor
+         pair and interpolates them, so GFluxBlender's per-ray cost is a
+         table lookup.  All the final flavors of a ray are interpolated
+         together and kept, since GFluxBlender asks for them one at a
+         time with the same E and L.
+
+         Config:  "E=emin,emax,ne [L=lmin,lmax,nl | L=dist] | <mixer> <its config>"
+           e.g. MixerConfig: "genie::flux::GFlavorMixerTable E=0.1,20,2000 L=810000 | ..."
+         where <mixer> is what MixerConfig would otherwise hold (map,
+         swap, fixedfrac or a GFlavorMixerFactory class name).  A single
+         L (fixed baseline) gives a table in E only.  Rays off the grid
+         go to the wrapped mixer directly.
+
+         Interpolated probabilities are clamped to [0,1] and the row is
+         scaled back to its interpolated sum, so a unitary mixer stays
+         unitary.  When a flavor's table is filled it is compared with
+         the wrapped mixer at 1000 random points between the grid points;
+         the largest difference is logged, with a warning above 1e-3
+         (oscillations too fast for the grid spacing).
+
+\created October 16, 2026
+
+*/
+//____________________________________________________________________________
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "GENIE/Tools/Flux/GFlavorMixerI.h"
+
+namespace genie {
+namespace flux {
+
+class GFlavorMixerTable: public GFlavorMixerI {
+public:
+	GFlavorMixerTable();
+	~GFlavorMixerTable();
+
+	// GFlavorMixerI
+	void Config(std::string config) override; ///< grid, then "|" and the wrapped mixer
+	double Probability(int pdg_initial, int pdg_final,
+	                   double energy, double dist) override; ///< interpolated
+	void PrintConfig(bool verbose=true) override;
+
+	/// probabilities for every final flavor (FinalFlavors() order) at once;
+	/// valid until the next call
+	const double* Probabilities(int pdg_initial, double energy, double dist);
+	static const std::vector<int>& FinalFlavors(void); ///< nue, nuebar, numu, numubar, nutau, nutaubar, 0 (sterile)
+
+private:
+	static int InitialIndex(int pdg); ///< -1 if not a neutrino
+	static int FinalIndex(int pdg); ///< -1 if not in FinalFlavors()
+	void FillTable(int iinit); ///< ask the wrapped mixer for one initial flavor
+	void Interpolate(int iinit, double x, double y, double* row) const; ///< at grid coordinates x (E), y (L)
+
+	GFlavorMixerI* fMixer; ///< owned, does the real calculation
+	double fLogEMin; ///< grid in log(E/GeV)
+	double fDLogE;
+	int fNE;
+	double fLMin; ///< grid in L (m)
+	double fDL;
+	int fNL;
+	std::vector< std::vector<double> > fTable; ///< per initial flavor: [iL][iE][final], empty until used
+
+	// the last row looked up
+	int fRowInit;
+	double fRowE;
+	double fRowL;
+	std::vector<double> fRow;
+};
+
+} // flux namespace
+} // genie namespace
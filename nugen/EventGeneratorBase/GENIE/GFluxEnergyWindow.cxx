@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GFluxEnergyWindow.cxx
+/// \brief A GFluxI that only passes on rays in an energy window
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "TLorentzVector.h"
+
+// NuGen includes
+#include "nugen/EventGeneratorBase/GENIE/GFluxEnergyWindow.h"
+
+// Framework includes
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace evgb {
+
+  //--------------------------------------------------
+  // tree_ fluxes count their exposure in POTs
+  GFluxEnergyWindow::GFluxEnergyWindow(genie::GFluxI* fluxD, double emin, double emax)
+    : genie::flux::GFluxExposureI(genie::flux::kPOTs)
+    , fFluxD    (fluxD)
+    , fExposureD(dynamic_cast<genie::flux::GFluxExposureI*>(fluxD))
+    , fEMin     (emin)
+    , fEMax     (emax)
+    , fNRejected(0)
+  {
+  }
+
+  //--------------------------------------------------
+  GFluxEnergyWindow::~GFluxEnergyWindow()
+  {
+    delete fFluxD;
+  }
+
+  //--------------------------------------------------
+  const genie::PDGCodeList& GFluxEnergyWindow::FluxParticles(void)
+  {
+    return fFluxD->FluxParticles();
+  }
+
+  //--------------------------------------------------
+  double GFluxEnergyWindow::MaxEnergy(void)
+  {
+    // GMCJDriver scales the interaction probabilities to this
+    return std::min(fEMax,fFluxD->MaxEnergy());
+  }
+
+  //--------------------------------------------------
+  bool GFluxEnergyWindow::GenerateNext(void)
+  {
+    long int nmiss = 0;
+    while ( fFluxD->GenerateNext() ) {
+      double e = fFluxD->Momentum().E();
+      if ( e >= fEMin && e <= fEMax ) return true;
+      ++fNRejected;
+      if ( ++nmiss % 10000000 == 0 ) {
+        mf::LogWarning("GFluxEnergyWindow")
+          << nmiss << " rays in a row outside [" << fEMin << "," << fEMax << "] GeV";
+      }
+    }
+    // let the caller decide (End() or try again), as for the driver itself
+    return false;
+  }
+
+  //--------------------------------------------------
+  int GFluxEnergyWindow::PdgCode(void)
+  {
+    return fFluxD->PdgCode();
+  }
+
+  //--------------------------------------------------
+  double GFluxEnergyWindow::Weight(void)
+  {
+    return fFluxD->Weight();
+  }
+
+  //--------------------------------------------------
+  const TLorentzVector& GFluxEnergyWindow::Momentum(void)
+  {
+    return fFluxD->Momentum();
+  }
+
+  //--------------------------------------------------
+  const TLorentzVector& GFluxEnergyWindow::Position(void)
+  {
+    return fFluxD->Position();
+  }
+
+  //--------------------------------------------------
+  bool GFluxEnergyWindow::End(void)
+  {
+    return fFluxD->End();
+  }
+
+  //--------------------------------------------------
+  long int GFluxEnergyWindow::Index(void)
+  {
+    return fFluxD->Index();
+  }
+
+  //--------------------------------------------------
+  void GFluxEnergyWindow::Clear(Option_t* opt)
+  {
+    fFluxD->Clear(opt);
+  }
+
+  //--------------------------------------------------
+  void GFluxEnergyWindow::GenerateWeighted(bool gen_weighted)
+  {
+    fFluxD->GenerateWeighted(gen_weighted);
+  }
+
+  //--------------------------------------------------
+  double GFluxEnergyWindow::GetTotalExposure() const
+  {
+    return ( fExposureD ) ? fExposureD->GetTotalExposure() : 0;
+  }
+
+  //--------------------------------------------------
+  long int GFluxEnergyWindow::NFluxNeutrinos() const
+  {
+    return ( fExposureD ) ? fExposureD->NFluxNeutrinos() : 0;
+  }
+
+} // namespace evgb
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GFluxEnergyWindow.h
+/// \class evgb::GFluxEnergyWindow
+/// \brief A GFluxI that only passes on the rays of another flux driver
+///        with an energy inside [emin,emax]
+///
+///        The rays outside are thrown away before GMCJDriver sees them
+///        (no path lengths, no interaction probabilities), but the
+///        wrapped driver has already counted them, so the exposure
+///        (GFluxExposureI) is the wrapped driver's, unchanged.  The
+///        current ray is the wrapped driver's current ray, so its
+///        pass-through info (evgb::FillMCFlux, dk2nu) is still good.
+///
+///        Installed by GENIEHelper (FluxEnergyWindow) around tree_ fluxes.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_GFLUXENERGYWINDOW_H
+#define EVGB_GFLUXENERGYWINDOW_H
+
+//GENIE includes
+#ifdef GENIE_PRE_R3
+  #include "EVGDrivers/GFluxI.h"
+  #include "FluxDrivers/GFluxExposureI.h"
+#else
+  #include "GENIE/Framework/EventGen/GFluxI.h"
+  #include "GENIE/Tools/Flux/GFluxExposureI.h"
+#endif
+
+namespace evgb {
+
+  class GFluxEnergyWindow : public genie::GFluxI,
+                            public genie::flux::GFluxExposureI {
+
+  public:
+
+    /// adopts fluxD
+    GFluxEnergyWindow(genie::GFluxI* fluxD, double emin, double emax);
+    ~GFluxEnergyWindow();
+
+    // GFluxI
+    const genie::PDGCodeList& FluxParticles(void) override;
+    double                    MaxEnergy(void) override;   ///< the smaller of emax and the driver's
+    bool                      GenerateNext(void) override;
+    int                       PdgCode(void) override;
+    double                    Weight(void) override;
+    const TLorentzVector&     Momentum(void) override;
+    const TLorentzVector&     Position(void) override;
+    bool                      End(void) override;
+    long int                  Index(void) override;
+    void                      Clear(Option_t* opt) override;
+    void                      GenerateWeighted(bool gen_weighted) override;
+
+    // GFluxExposureI, including the rays outside the window
+    double                    GetTotalExposure() const override;
+    long int                  NFluxNeutrinos() const override;
+
+    genie::GFluxI*            GetFluxGenerator() const { return fFluxD; }
+
+    double                    EMin()       const { return fEMin;      }
+    double                    EMax()       const { return fEMax;      }
+    long int                  NRejected()  const { return fNRejected; }  ///< rays thrown away
+
+  private:
+
+    genie::GFluxI*                 fFluxD;
+    genie::flux::GFluxExposureI*   fExposureD;  ///< fFluxD, if it keeps exposure
+    double                         fEMin;
+    double                         fEMax;
+    long int                       fNRejected;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_GFLUXENERGYWINDOW_H
@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GFluxReadAhead.cxx
+/// \brief A GFluxI that reads the next rays of another one on a
+///        background thread
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <utility>
+
+#include "TString.h"
+
+// NuGen includes
+#include "nugen/EventGeneratorBase/GENIE/GFluxReadAhead.h"
+#include "nugen/EventGeneratorBase/GENIE/GENIE2ART.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxEnergyWindow.h"
+
+// dk2nu
+#include "dk2nu/tree/dk2nu.h"
+#include "dk2nu/tree/NuChoice.h"
+#include "dk2nu/genie/GDk2NuFlux.h"
+
+// Framework includes
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace evgb {
+
+  //--------------------------------------------------
+  GFluxReadAhead::Ray::Ray()
+    : ok      (false)
+    , end     (false)
+    , pdg     (0)
+    , weight  (0)
+    , index   (-1)
+    , exposure(0)
+    , nnu     (0)
+  {
+  }
+
+  //--------------------------------------------------
+  // tree_ fluxes count their exposure in POTs
+  GFluxReadAhead::GFluxReadAhead(genie::GFluxI* fluxD, unsigned int nrays)
+    : genie::flux::GFluxExposureI(genie::flux::kPOTs)
+    , fFluxD      (fluxD)
+    , fExposureD  (dynamic_cast<genie::flux::GFluxExposureI*>(fluxD))
+    , fDk2NuD     (0)
+    , fRing       ( (nrays > 0) ? nrays : 1 )
+    , fHead       (0)
+    , fCount      (0)
+    , fStop       (false)
+    , fDone       (false)
+    , fWaitSeconds(0)
+  {
+    // the dk2nu driver might be behind an energy window
+    genie::GFluxI* realD = fluxD;
+    GFluxEnergyWindow* window = dynamic_cast<GFluxEnergyWindow*>(fluxD);
+    if ( window ) realD = window->GetFluxGenerator();
+    fDk2NuD = dynamic_cast<genie::flux::GDk2NuFlux*>(realD);
+    CopyExposure(fCurrent);
+  }
+
+  //--------------------------------------------------
+  GFluxReadAhead::~GFluxReadAhead()
+  {
+    StopReading();
+    delete fFluxD;
+  }
+
+  //--------------------------------------------------
+  const genie::PDGCodeList& GFluxReadAhead::FluxParticles(void)
+  {
+    // fixed once the driver is configured, safe to ask while reading
+    return fFluxD->FluxParticles();
+  }
+
+  //--------------------------------------------------
+  double GFluxReadAhead::MaxEnergy(void)
+  {
+    return fFluxD->MaxEnergy();
+  }
+
+  //--------------------------------------------------
+  bool GFluxReadAhead::GenerateNext(void)
+  {
+    if ( ! fWorker.joinable() ) {
+      fWorker = std::thread(&GFluxReadAhead::Work,this);
+    }
+
+    size_t slot = 0;
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      if ( fCount == 0 && ! fError && ! fDone ) {
+        auto start = std::chrono::steady_clock::now();
+        fNotEmpty.wait(lock,[this] { return fCount > 0 || fError || fDone; });
+        fWaitSeconds +=
+          std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+      }
+      if ( fError ) std::rethrow_exception(fError);
+      if ( fCount == 0 ) {
+        // the worker handed out the ray that hit End() already
+        fCurrent.ok = false;
+        return false;
+      }
+      slot = fHead;
+    }
+
+    // the worker doesn't touch a slot until it is handed back;
+    // swap rather than copy so the Dk2Nu objects are reused
+    std::swap(fCurrent,fRing[slot]);
+
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fHead = ( fHead + 1 ) % fRing.size();
+      --fCount;
+    }
+    fNotFull.notify_one();
+    return fCurrent.ok;
+  }
+
+  //--------------------------------------------------
+  int GFluxReadAhead::PdgCode(void)
+  {
+    return fCurrent.pdg;
+  }
+
+  //--------------------------------------------------
+  double GFluxReadAhead::Weight(void)
+  {
+    return fCurrent.weight;
+  }
+
+  //--------------------------------------------------
+  const TLorentzVector& GFluxReadAhead::Momentum(void)
+  {
+    return fCurrent.p4;
+  }
+
+  //--------------------------------------------------
+  const TLorentzVector& GFluxReadAhead::Position(void)
+  {
+    return fCurrent.x4;
+  }
+
+  //--------------------------------------------------
+  bool GFluxReadAhead::End(void)
+  {
+    return fCurrent.end;
+  }
+
+  //--------------------------------------------------
+  long int GFluxReadAhead::Index(void)
+  {
+    return fCurrent.index;
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::Clear(Option_t* opt)
+  {
+    StopReading();
+    fFluxD->Clear(opt);
+    if ( TString(opt).Contains("CycleHistory") ) {
+      fCurrent.end = fFluxD->End();
+      CopyExposure(fCurrent);
+    }
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::GenerateWeighted(bool gen_weighted)
+  {
+    StopReading();
+    fFluxD->GenerateWeighted(gen_weighted);
+  }
+
+  //--------------------------------------------------
+  double GFluxReadAhead::GetTotalExposure() const
+  {
+    return fCurrent.exposure;
+  }
+
+  //--------------------------------------------------
+  long int GFluxReadAhead::NFluxNeutrinos() const
+  {
+    return fCurrent.nnu;
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::StopReading()
+  {
+    if ( fWorker.joinable() ) {
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = true;
+      }
+      fNotFull.notify_all();
+      fWorker.join();
+    }
+    if ( fCount > 0 ) {
+      mf::LogDebug("GFluxReadAhead") << "dropping " << fCount << " rays read ahead";
+    }
+    fHead  = 0;
+    fCount = 0;
+    fStop  = false;
+    fDone  = false;
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::Work()
+  {
+    const size_t nslots = fRing.size();
+    while ( true ) {
+      size_t slot = 0;
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fNotFull.wait(lock,[this,nslots] { return fStop || fCount < nslots; });
+        if ( fStop ) return;
+        slot = ( fHead + fCount ) % nslots;
+      }
+
+      Ray& ray = fRing[slot];
+      try {
+        Read(ray);
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fError = std::current_exception();
+        fNotEmpty.notify_one();
+        return;
+      }
+
+      bool done = ( ! ray.ok && ray.end );
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        ++fCount;
+        fDone = done;
+      }
+      fNotEmpty.notify_one();
+      if ( done ) return;
+    }
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::Read(Ray& ray)
+  {
+    ray.ok  = fFluxD->GenerateNext();
+    ray.end = fFluxD->End();
+    CopyExposure(ray);
+    if ( ! ray.ok ) return;
+
+    ray.pdg    = fFluxD->PdgCode();
+    ray.weight = fFluxD->Weight();
+    ray.p4     = fFluxD->Momentum();
+    ray.x4     = fFluxD->Position();
+    ray.index  = fFluxD->Index();
+    evgb::FillMCFlux(fFluxD,ray.mcflux);
+
+    if ( fDk2NuD ) {
+      if ( ! ray.dk2nu    ) ray.dk2nu.reset(new bsim::Dk2Nu);
+      if ( ! ray.nuchoice ) ray.nuchoice.reset(new bsim::NuChoice);
+      *ray.dk2nu    = fDk2NuD->GetDk2Nu();
+      *ray.nuchoice = fDk2NuD->GetNuChoice();
+    }
+  }
+
+  //--------------------------------------------------
+  void GFluxReadAhead::CopyExposure(Ray& ray) const
+  {
+    ray.exposure = ( fExposureD ) ? fExposureD->GetTotalExposure() : 0;
+    ray.nnu      = ( fExposureD ) ? fExposureD->NFluxNeutrinos()   : 0;
+  }
+
+} // namespace evgb
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GFluxReadAhead.h
+/// \class evgb::GFluxReadAhead
+/// \brief A GFluxI that runs another (file based) flux driver on a
+///        background thread, keeping the next few rays decoded in a ring
+///        buffer so GMCJDriver doesn't wait on TTree reads
+///
+///        Everything GENIEHelper and evgb::FillMCFlux() ask about a ray
+///        (pdg, weight, p4, x4, index, exposure, the filled simb::MCFlux
+///        and, for GDk2NuFlux, the Dk2Nu/NuChoice objects) is copied when
+///        the ray is read, so it describes the ray GMCJDriver is using and
+///        not the one the wrapped driver has reached.  The wrapped driver
+///        belongs to the worker while it runs; it only uses the RandomGen
+///        RndFlux() stream, so the sequence of rays is unchanged.
+///
+///        The worker starts with the first GenerateNext().  Clear() and
+///        GenerateWeighted() stop it and drop the rays read ahead (they
+///        were already counted in the exposure) before being forwarded.
+///
+///        Installed by GENIEHelper (FluxReadAhead) around tree_ fluxes.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_GFLUXREADAHEAD_H
+#define EVGB_GFLUXREADAHEAD_H
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TLorentzVector.h"
+
+//GENIE includes
+#ifdef GENIE_PRE_R3
+  #include "EVGDrivers/GFluxI.h"
+  #include "FluxDrivers/GFluxExposureI.h"
+#else
+  #include "GENIE/Framework/EventGen/GFluxI.h"
+  #include "GENIE/Tools/Flux/GFluxExposureI.h"
+#endif
+
+#include "nusimdata/SimulationBase/MCFlux.h"
+
+namespace genie {
+  namespace flux {
+    class GDk2NuFlux;
+  }
+}
+namespace bsim {
+  class Dk2Nu;
+  class NuChoice;
+}
+
+namespace evgb {
+
+  class GFluxReadAhead : public genie::GFluxI,
+                         public genie::flux::GFluxExposureI {
+
+  public:
+
+    /// adopts fluxD; nrays is the size of the ring buffer
+    GFluxReadAhead(genie::GFluxI* fluxD, unsigned int nrays);
+    ~GFluxReadAhead();
+
+    // GFluxI
+    const genie::PDGCodeList& FluxParticles(void) override;
+    double                    MaxEnergy(void) override;
+    bool                      GenerateNext(void) override;
+    int                       PdgCode(void) override;
+    double                    Weight(void) override;
+    const TLorentzVector&     Momentum(void) override;
+    const TLorentzVector&     Position(void) override;
+    bool                      End(void) override;
+    long int                  Index(void) override;
+    void                      Clear(Option_t* opt) override;
+    void                      GenerateWeighted(bool gen_weighted) override;
+
+    // GFluxExposureI (zero if the wrapped driver doesn't keep it)
+    double                    GetTotalExposure() const override;
+    long int                  NFluxNeutrinos() const override;
+
+    /// the current ray's pass-through info, for evgb::FillMCFlux()
+    const simb::MCFlux&       CurrentMCFlux() const { return fCurrent.mcflux; }
+    /// non-null only if the wrapped driver is a GDk2NuFlux
+    const bsim::Dk2Nu*        GetDk2Nu()    const { return fCurrent.dk2nu.get();    }
+    const bsim::NuChoice*     GetNuChoice() const { return fCurrent.nuchoice.get(); }
+
+    /// the wrapped driver; StopReading() before touching it
+    genie::GFluxI*            GetFluxGenerator() const { return fFluxD; }
+
+    /// stop the worker and drop whatever it had read ahead;
+    /// the next GenerateNext() starts it again
+    void                      StopReading();
+
+    unsigned int              NRaysAhead()  const { return fRing.size(); }
+    double                    WaitSeconds() const { return fWaitSeconds; }  ///< blocked in GenerateNext()
+
+  private:
+
+    /// everything that is asked about one ray
+    struct Ray {
+      Ray();
+      bool                             ok;       ///< GenerateNext() result
+      bool                             end;
+      int                              pdg;
+      double                           weight;
+      TLorentzVector                   p4;
+      TLorentzVector                   x4;
+      long int                         index;
+      double                           exposure;
+      long int                         nnu;
+      simb::MCFlux                     mcflux;
+      std::unique_ptr<bsim::Dk2Nu>     dk2nu;
+      std::unique_ptr<bsim::NuChoice>  nuchoice;
+    };
+
+    void Work();
+    void Read(Ray& ray);       ///< step the wrapped driver and copy its ray
+    void CopyExposure(Ray& ray) const;
+
+    genie::GFluxI*                 fFluxD;
+    genie::flux::GFluxExposureI*   fExposureD;  ///< fFluxD, if it keeps exposure
+    genie::flux::GDk2NuFlux*       fDk2NuD;     ///< fFluxD, if it is a dk2nu driver
+
+    std::vector<Ray>               fRing;
+    size_t                         fHead;       ///< next ray to hand out
+    size_t                         fCount;      ///< rays ready
+    Ray                            fCurrent;    ///< the ray GMCJDriver is using
+
+    std::thread                    fWorker;
+    std::mutex                     fMutex;      ///< guards fHead, fCount, fStop, fDone, fError
+    std::condition_variable        fNotEmpty;
+    std::condition_variable        fNotFull;
+    bool                           fStop;
+    bool                           fDone;       ///< worker reached End()
+    std::exception_ptr             fError;
+    double                         fWaitSeconds;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_GFLUXREADAHEAD_H
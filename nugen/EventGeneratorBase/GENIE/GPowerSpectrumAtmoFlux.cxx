@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <limits>
 
 #include <TMath.h>
 #include <TLorentzVector.h>
@@ -17,6 +19,7 @@
 #include "TFile.h"
 #include "TH3D.h"
 #include "TH2.h"
+#include "TRandom3.h"
 
 FLUXDRIVERREG4(genie,flux,GPowerSpectrumAtmoFlux,genie::flux::GPowerSpectrumAtmoFlux)
 
@@ -35,7 +38,7 @@ GPowerSpectrumAtmoFlux::GPowerSpectrumAtmoFlux()
 
 GPowerSpectrumAtmoFlux::~GPowerSpectrumAtmoFlux()
 {
-
+	delete fSobol;
 }
 
 
@@ -64,119 +67,187 @@ double GPowerSpectrumAtmoFlux::MinEnergy(void)
 
 bool GPowerSpectrumAtmoFlux::GenerateNext(void)
 {
-	// Reset previously generated neutrino code / 4-p / 4-x
-	this->ResetSelection();
+	// Take the next ray of the batch, making a new batch when used up
+	if ( fBatchNext >= fBatchFilled ) this->GenerateBatch();
+	int k = fBatchNext++;
+
+	fgPdgC  = fBatchPdg[k];
+	fWeight = fBatchWeight[k];
+	fgP4.SetPxPyPzE(fBatchP[0][k], fBatchP[1][k], fBatchP[2][k], fBatchEv[k]);
+	fgX4.SetXYZT   (fBatchX[0][k], fBatchX[1][k], fBatchX[2][k], 0.);
+
+	// Increment flux neutrino counter used for sample normalization purposes.
+	fNNeutrinos++;
+
+	// Report and exit (formatting the 4-vectors only if it gets printed)
+	if ( (*Messenger::Instance())("Flux").isPriorityEnabled(pINFO) ) {
+		LOG("Flux", pINFO)
+		   << "Generated neutrino: "
+		   << "\n pdg-code: " << fgPdgC
+		   << "\n p4: " << utils::print::P4AsShortString(&fgP4)
+		   << "\n x4: " << utils::print::X4AsString(&fgX4);
+	}
 
-	// Get a RandomGen instance
-	RandomGen * rnd = RandomGen::Instance();
+	return true;
+}
 
-	// Generate (Ev, costheta, phi)
-	double Ev       = 0.;
-	double costheta = 0.;
-	double phi      = 0;
-	double weight   = 0;
-	int    nu_pdg   = 0;
+//_________________________________________________________________________
+
+void GPowerSpectrumAtmoFlux::GenerateBatch(void)
+{
+	TRandom3& rnd = RandomGen::Instance()->RndFlux();
+	const int n = kBatchSize;
+	const unsigned int nnu = fPdgCList->size();
+	const bool displace = ( fRt > 0.0 );
+
+	// The random numbers, ray by ray in the order GenerateNext() always
+	// drew them: Ev, costheta, phi, flavor (or the proposal cell first),
+	// then the displacement.  Quasi-random: Ev, costheta, phi, the
+	// displacement and the cell are the next Sobol point, RndFlux only
+	// picks the flavor without importance sampling
+	const bool importance = this->ImportanceSampling();
+	double point[6];
+	for ( int k = 0; k < n; ++k ) {
+		if ( fSobol ) fSobol->Next(point);
+		if ( importance ) {
+			// one uniform picks the column, the remainder decides alias or not
+			double u = ( fSobol ? point[5] : rnd.Rndm() ) * fCellAliasProb.size();
+			size_t icell = std::min(size_t(u),fCellAliasProb.size()-1);
+			if ( u - icell >= fCellAliasProb[icell] ) icell = fCellAlias[icell];
+			fBatchCell[k] = icell;
+		}
+		if ( fSobol ) {
+			fBatchEv[k]     = point[0];
+			fBatchCosth[k]  = point[1];
+			fBatchPhi[k]    = point[2];
+			fBatchPsi[k]    = point[3];
+			fBatchRadius[k] = point[4];
+		} else {
+			fBatchEv[k]    = rnd.Rndm();
+			fBatchCosth[k] = rnd.Rndm();
+			fBatchPhi[k]   = rnd.Rndm();
+		}
+		if ( ! importance ) fBatchPdg[k] = (*fPdgCList)[rnd.Integer(nnu)];
+		if ( displace && ! fSobol ) {
+			fBatchPsi[k]    = rnd.Rndm();
+			fBatchRadius[k] = rnd.Rndm();
+		}
+	}
 
 	// generate events according to a power law spectrum,
 	// then weight events by inverse power law
 	// (note: cannot use index alpha=1)
-	double alpha = fSpectralIndex;
-
-	double emin = TMath::Power(this->MinEnergy(),1.0-alpha);
-	double emax = TMath::Power(this->MaxEnergy(),1.0-alpha);
-	Ev          = TMath::Power(emin+(emax-emin)*rnd->RndFlux().Rndm(),1.0/(1.0-alpha));
-	costheta    = -1+2*rnd->RndFlux().Rndm();
-	phi         = 2.*kPi* rnd->RndFlux().Rndm();
-
-	unsigned int nnu = fPdgCList->size();
-	unsigned int inu = rnd->RndFlux().Integer(nnu);
-	nu_pdg   = (*fPdgCList)[inu];
-	weight = this->ComputeWeight(nu_pdg, Ev, costheta, phi);
-
-	// Compute etc trigonometric numbers
-	double sintheta  = TMath::Sqrt(1-costheta*costheta);
-	double cosphi    = TMath::Cos(phi);
-	double sinphi    = TMath::Sin(phi);
-
-	// Set the neutrino pdg code
-	fgPdgC = nu_pdg;
-
-	// Set the neutrino weight
-	fWeight = weight;
-
-	// Compute the neutrino momentum
-	// The `-1' means it is directed towards the detector.
-	double pz = -1.* Ev * costheta;
-	double py = -1.* Ev * sintheta * sinphi;
-	double px = -1.* Ev * sintheta * cosphi;
-
-	// Default vertex is at the origin
-	double z = 0.0;
-	double y = 0.0;
-	double x = 0.0;
-
-	// Shift the neutrino position onto the flux generation surface.
+	const double alpha = fSpectralIndex;
+	if ( importance ) {
+		// the same inside the proposal cell, weighted by flux / proposal
+		for ( int k = 0; k < n; ++k ) {
+			int icell = fBatchCell[k];
+			fBatchPdg[k]   = fCellPdg[icell];
+			fBatchEv[k]    = TMath::Power(fCellA[icell]+(fCellB[icell]-fCellA[icell])*fBatchEv[k],1.0/(1.0-alpha));
+			fBatchCosth[k] = fCellCosLow[icell] + (fCellCosHigh[icell]-fCellCosLow[icell])*fBatchCosth[k];
+			fBatchPhi[k]   = 2.*kPi*fBatchPhi[k];
+		}
+		for ( int k = 0; k < n; ++k ) {
+			fBatchWeight[k] = this->WeightFor(fBatchPdg[k], fBatchEv[k], fBatchCosth[k], fBatchPhi[k],
+			                                  fCellDensity[fBatchCell[k]]);
+		}
+	} else {
+		const double emin  = TMath::Power(this->MinEnergy(),1.0-alpha);
+		const double emax  = TMath::Power(this->MaxEnergy(),1.0-alpha);
+		for ( int k = 0; k < n; ++k ) {
+			fBatchEv[k]    = TMath::Power(emin+(emax-emin)*fBatchEv[k],1.0/(1.0-alpha));
+			fBatchCosth[k] = -1+2*fBatchCosth[k];
+			fBatchPhi[k]   = 2.*kPi*fBatchPhi[k];
+		}
+		for ( int k = 0; k < n; ++k ) {
+			fBatchWeight[k] = this->ComputeWeight(fBatchPdg[k], fBatchEv[k], fBatchCosth[k], fBatchPhi[k]);
+		}
+	}
+
+	// The momentum: the `-1' means it is directed towards the detector.
 	// The position is computed at the surface of a sphere with R=fRl
 	// at the topocentric horizontal (THZ) coordinate system.
-	if( fRl>0.0 ){
-	z += fRl * costheta;
-	y += fRl * sintheta * sinphi;
-	x += fRl * sintheta * cosphi;
+	double* x  = fBatchX[0].data();
+	double* y  = fBatchX[1].data();
+	double* z  = fBatchX[2].data();
+	double* px = fBatchP[0].data();
+	double* py = fBatchP[1].data();
+	double* pz = fBatchP[2].data();
+	const double rl = ( fRl > 0.0 ) ? fRl : 0.0;
+	for ( int k = 0; k < n; ++k ) {
+		double costheta = fBatchCosth[k];
+		double sintheta = TMath::Sqrt(1-costheta*costheta);
+		double cosphi   = TMath::Cos(fBatchPhi[k]);
+		double sinphi   = TMath::Sin(fBatchPhi[k]);
+		pz[k] = -1.* fBatchEv[k] * costheta;
+		py[k] = -1.* fBatchEv[k] * sintheta * sinphi;
+		px[k] = -1.* fBatchEv[k] * sintheta * cosphi;
+		z[k]  = rl * costheta;
+		y[k]  = rl * sintheta * sinphi;
+		x[k]  = rl * sintheta * cosphi;
 	}
 
 	// Apply user-defined rotation from THZ -> user-defined topocentric
 	// coordinate system.
-	if( !fRotTHz2User.IsIdentity() )
-	{
-	TVector3 tx3(x, y, z );
-	TVector3 tp3(px,py,pz);
-
-	tx3 = fRotTHz2User * tx3;
-	tp3 = fRotTHz2User * tp3;
-
-	x  = tx3.X();
-	y  = tx3.Y();
-	z  = tx3.Z();
-	px = tp3.X();
-	py = tp3.Y();
-	pz = tp3.Z();
+	if( !fRotTHz2User.IsIdentity() ) {
+		const TRotation& r = fRotTHz2User;
+		for ( int k = 0; k < n; ++k ) {
+			double tx = r.XX()*x[k] + r.XY()*y[k] + r.XZ()*z[k];
+			double ty = r.YX()*x[k] + r.YY()*y[k] + r.YZ()*z[k];
+			double tz = r.ZX()*x[k] + r.ZY()*y[k] + r.ZZ()*z[k];
+			x[k] = tx; y[k] = ty; z[k] = tz;
+			double tpx = r.XX()*px[k] + r.XY()*py[k] + r.XZ()*pz[k];
+			double tpy = r.YX()*px[k] + r.YY()*py[k] + r.YZ()*pz[k];
+			double tpz = r.ZX()*px[k] + r.ZY()*py[k] + r.ZZ()*pz[k];
+			px[k] = tpx; py[k] = tpy; pz[k] = tpz;
+		}
 	}
 
 	// If the position is left as is, then all generated neutrinos
 	// would point towards the origin.
 	// Displace the position randomly on the surface that is
-	// perpendicular to the selected point P(xo,yo,zo) on the sphere
-	if( fRt>0.0 ){
-	TVector3 vec(x,y,z);               // vector towards selected point
-	TVector3 dvec1 = vec.Orthogonal(); // orthogonal vector
-	TVector3 dvec2 = dvec1;            // second orthogonal vector
-	dvec2.Rotate(-kPi/2.0,vec);        // rotate second vector by 90deg,
-	                                   // now forming a new orthogonal cartesian coordinate system
-	double psi = 2.*kPi* rnd->RndFlux().Rndm(); // rndm angle [0,2pi]
-	double random = rnd->RndFlux().Rndm();      // rndm number  [0,1]
-	dvec1.SetMag(TMath::Sqrt(random)*fRt*TMath::Cos(psi));
-	dvec2.SetMag(TMath::Sqrt(random)*fRt*TMath::Sin(psi));
-	x += dvec1.X() + dvec2.X();
-	y += dvec1.Y() + dvec2.Y();
-	z += dvec1.Z() + dvec2.Z();
+	// perpendicular to the selected point P(xo,yo,zo) on the sphere,
+	// along e1 = TVector3::Orthogonal() of it and e2 = e1 rotated by
+	// -90deg around it
+	if ( displace ) {
+		for ( int k = 0; k < n; ++k ) {
+			double mag = TMath::Sqrt(x[k]*x[k] + y[k]*y[k] + z[k]*z[k]);
+			if ( mag <= 0 ) continue; // no direction to be perpendicular to
+			double ux = x[k]/mag, uy = y[k]/mag, uz = z[k]/mag;
+			double ax = std::fabs(ux), ay = std::fabs(uy), az = std::fabs(uz);
+			double e1x, e1y, e1z;
+			if ( ax < ay ) {
+				if ( ax < az ) { e1x = 0;   e1y = uz;  e1z = -uy; }
+				else           { e1x = uy;  e1y = -ux; e1z = 0;   }
+			} else {
+				if ( ay < az ) { e1x = -uz; e1y = 0;   e1z = ux;  }
+				else           { e1x = uy;  e1y = -ux; e1z = 0;   }
+			}
+			double e1 = TMath::Sqrt(e1x*e1x + e1y*e1y + e1z*e1z);
+			e1x /= e1; e1y /= e1; e1z /= e1;
+			double e2x = e1y*uz - e1z*uy;
+			double e2y = e1z*ux - e1x*uz;
+			double e2z = e1x*uy - e1y*ux;
+			double psi = 2.*kPi*fBatchPsi[k];                  // rndm angle [0,2pi]
+			double rt  = TMath::Sqrt(fBatchRadius[k])*fRt;     // rndm radius, uniform on the disk
+			double d1  = rt*TMath::Cos(psi);
+			double d2  = rt*TMath::Sin(psi);
+			x[k] += d1*e1x + d2*e2x;
+			y[k] += d1*e1y + d2*e2y;
+			z[k] += d1*e1z + d2*e2z;
+		}
 	}
 
-	// Set the neutrino momentum and position 4-vectors with values
-	// calculated at previous steps.
-	fgP4.SetPxPyPzE(px, py, pz, Ev);
-	fgX4.SetXYZT   (x,  y,  z,  0.);
-
-	// Increment flux neutrino counter used for sample normalization purposes.
-	fNNeutrinos++;
+	fBatchNext   = 0;
+	fBatchFilled = n;
+}
 
-	// Report and exit
-	LOG("Flux", pINFO)
-	   << "Generated neutrino: "
-	   << "\n pdg-code: " << fgPdgC
-	   << "\n p4: " << utils::print::P4AsShortString(&fgP4)
-	   << "\n x4: " << utils::print::X4AsString(&fgX4);
+//_________________________________________________________________________
 
-	return true;
+void GPowerSpectrumAtmoFlux::DropBatch(void)
+{
+	fBatchNext   = 0;
+	fBatchFilled = 0;
 }
 
 //________________________________________________________________
@@ -277,6 +348,7 @@ void GPowerSpectrumAtmoFlux::SetSpectralIndex(double index)
 void GPowerSpectrumAtmoFlux::SetUserCoordSystem(TRotation &rotation)
 {
   fRotTHz2User = rotation;
+  this->DropBatch();
 }
 
 //__________________________________________________________________________________
@@ -289,6 +361,8 @@ void GPowerSpectrumAtmoFlux::Initialize(void)
 	fPdgCList = new PDGCodeList(allow_dup);
 
 	fSpectralIndex = 2.0;
+	fImportanceSampling = false;
+	fSobol = 0;
 
 	fMinEvCut = 0.01;
 	fMaxEvCut = 9999999999;
@@ -307,6 +381,21 @@ void GPowerSpectrumAtmoFlux::Initialize(void)
 	// Reset number of neutrinos thrown so far
 	fNNeutrinos = 0;
 
+	// Room for a batch of rays, none made yet
+	fBatchPdg.resize(kBatchSize);
+	fBatchCell.resize(kBatchSize);
+	fBatchEv.resize(kBatchSize);
+	fBatchCosth.resize(kBatchSize);
+	fBatchPhi.resize(kBatchSize);
+	fBatchPsi.resize(kBatchSize);
+	fBatchRadius.resize(kBatchSize);
+	fBatchWeight.resize(kBatchSize);
+	for ( int i = 0; i < 3; ++i ) {
+		fBatchX[i].resize(kBatchSize);
+		fBatchP[i].resize(kBatchSize);
+	}
+	this->DropBatch();
+
 	// Init the global gen weight
 	this->InitializeWeight();
 }
@@ -322,6 +411,7 @@ void GPowerSpectrumAtmoFlux::SetRadii(double Rlongitudinal, double Rtransverse)
   fRt = Rtransverse;
 
   fAgen = kPi*fRt*fRt;
+  this->DropBatch();
 }
 
 //________________________________________________________________________________
@@ -332,6 +422,7 @@ void GPowerSpectrumAtmoFlux::SetFlavors(std::vector<int> flavors)
 	for(int flavor : flavors){
 		fPdgCList->push_back(flavor);
 	}
+	this->DropBatch();
 }
 
 //________________________________________________________________________________
@@ -416,6 +507,7 @@ void GPowerSpectrumAtmoFlux::AddFluxFile(int nu_pdg, string filename)
   }
 }
 
+
 //_________________________________________________________________________________
 
 bool GPowerSpectrumAtmoFlux::LoadFluxData(void)
@@ -424,6 +516,8 @@ bool GPowerSpectrumAtmoFlux::LoadFluxData(void)
         << "Loading atmospheric neutrino flux simulation data";
 
   fPdgCList->clear();
+  this->DropBatch();
+  for ( int igrid = 0; igrid < kNGridFlavors; ++igrid ) fFluxGrid[igrid] = FluxGrid();
 
   bool loading_status = true;
 
@@ -450,7 +544,9 @@ bool GPowerSpectrumAtmoFlux::LoadFluxData(void)
     for ( ; hist_iter != fRawFluxHistoMap.end(); ++hist_iter) {
       int   nu_pdg = hist_iter->first;
       fPdgCList->push_back(nu_pdg);
+      this->BuildFluxGrid(nu_pdg);
     }
+    this->InitializeWeight(); //Proposal from the flux tables, if asked for
 
     LOG("Flux", pNOTICE)
           << "Atmospheric neutrino flux simulation data loaded!";
@@ -463,10 +559,177 @@ bool GPowerSpectrumAtmoFlux::LoadFluxData(void)
 }
 
 
+//_________________________________________________________________________
+
+int GPowerSpectrumAtmoFlux::GridIndex(int nu_pdg)
+{
+  switch ( nu_pdg ) {
+    case kPdgNuE:      return 0;
+    case kPdgAntiNuE:  return 1;
+    case kPdgNuMu:     return 2;
+    case kPdgAntiNuMu: return 3;
+    case kPdgNuTau:    return 4;
+    case kPdgAntiNuTau:return 5;
+    default:           return -1;
+  }
+}
+
+//_________________________________________________________________________
+
+void GPowerSpectrumAtmoFlux::BuildFluxGrid(int nu_pdg)
+{
+  int igrid = GridIndex(nu_pdg);
+  TH3D* h3 = fRawFluxHistoMap[nu_pdg];
+  TH2D* h2 = fRawFluxHistoMap2D[nu_pdg];
+  if ( igrid < 0 || ! h3 || ! h2 ) return;
+
+  // no binning in phi: the 2D histogram, as GetFlux
+  bool is3D = ( h3->GetZaxis()->GetNbins() > 1 );
+  const TAxis* axes[3] = { h3->GetXaxis(), h3->GetYaxis(), h3->GetZaxis() };
+
+  if ( axes[0]->GetBinCenter(1) <= 0 ) {
+    LOG("Flux", pWARN)
+      << "No flux grid for " << nu_pdg << ": energy bin centers must be > 0";
+    return;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  FluxGrid grid;
+  for ( int a = 0; a < 3; ++a ) {
+    GridAxis& axis = grid.axis[a];
+    // lookup variable: log(Ev), cos8, phi
+    auto var = [a](double x) { return ( a == 0 ) ? std::log(x) : x; };
+    axis.n    = ( a < 2 || is3D ) ? axes[a]->GetNbins() : 1;
+    axis.imax = std::max(axis.n-2,0);
+    for ( int i = 0; i < axis.n; ++i ) {
+      axis.x.push_back(axes[a]->GetBinCenter(i+1));
+      axis.node.push_back(var(axis.x.back()));
+    }
+    axis.node.push_back(inf);
+    axis.invdx.assign(std::max(axis.n-1,1),0.);
+    double spacing = inf;
+    for ( int i = 0; i+1 < axis.n; ++i ) {
+      axis.invdx[i] = 1./(axis.x[i+1]-axis.x[i]);
+      spacing = std::min(spacing,axis.node[i+1]-axis.node[i]);
+    }
+
+    // lookup cells of half the narrowest bin hold at most one node
+    axis.first = axis.node.front();
+    axis.last  = axis.node[axis.n-1];
+    int ncells = ( axis.n > 1 ) ? int(std::ceil(2.*(axis.last-axis.first)/spacing)) : 1;
+    axis.inv   = ( axis.n > 1 ) ? ncells/(axis.last-axis.first) : 0;
+    axis.cell.resize(ncells);
+    int inode = 0;
+    for ( int k = 0; k < ncells; ++k ) {
+      double start = axis.first + ( ( axis.n > 1 ) ? k/axis.inv : 0 );
+      while ( inode < axis.imax && axis.node[inode+1] <= start ) ++inode;
+      axis.cell[k] = inode;
+    }
+
+    if ( is3D ) {
+      // TH3::Interpolate: between the outer bin centers only
+      axis.lo = axis.first;
+      axis.hi = axis.last;
+    } else if ( a < 2 ) {
+      // TH2::Interpolate: anywhere in the histogram
+      axis.lo = ( a == 0 && axes[a]->GetXmin() <= 0 ) ? -inf : var(axes[a]->GetXmin());
+      axis.hi = var(axes[a]->GetXmax());
+    } else {
+      axis.lo = -inf;
+      axis.hi = inf;
+    }
+  }
+  grid.axis[2].stride = 1;
+  grid.axis[1].stride = grid.axis[2].n;
+  grid.axis[0].stride = size_t(grid.axis[1].n)*grid.axis[2].n;
+  for ( int a = 0; a < 3; ++a ) {
+    grid.axis[a].step = ( grid.axis[a].n > 1 ) ? grid.axis[a].stride : 0;
+  }
+
+  // the bin contents, contiguous
+  grid.flux.resize(size_t(grid.axis[0].n)*grid.axis[0].stride);
+  for ( int i0 = 0; i0 < grid.axis[0].n; ++i0 ) {
+    for ( int i1 = 0; i1 < grid.axis[1].n; ++i1 ) {
+      for ( int i2 = 0; i2 < grid.axis[2].n; ++i2 ) {
+        grid.flux[i0*grid.axis[0].stride + i1*grid.axis[1].stride + i2] =
+          ( is3D ) ? h3->GetBinContent(i0+1,i1+1,i2+1) : h2->GetBinContent(i0+1,i1+1);
+      }
+    }
+  }
+
+  // compare with the histogram interpolation inside the bin centers
+  TRandom3 rnd(20221216);
+  double maxdiff = 0;
+  const int ncheck = 1000;
+  for ( int icheck = 0; icheck < ncheck; ++icheck ) {
+    double u[3];
+    for ( int a = 0; a < 3; ++a ) {
+      u[a] = grid.axis[a].first + (grid.axis[a].last-grid.axis[a].first)*rnd.Rndm();
+    }
+    double energy = std::exp(u[0]);
+    double ref = ( is3D ) ? h3->Interpolate(energy,u[1],u[2]) : h2->Interpolate(energy,u[1]);
+    double val = this->GridFlux(grid,energy,u[0],u[1],u[2]);
+    if ( ref != 0 ) maxdiff = std::max(maxdiff,std::fabs(val-ref)/std::fabs(ref));
+    else            maxdiff = std::max(maxdiff,std::fabs(val));
+  }
+
+  LOG("Flux", pNOTICE)
+    << "Flux grid for " << nu_pdg << ": " << grid.axis[0].n << " x " << grid.axis[1].n
+    << " x " << grid.axis[2].n << " (log Ev x cos8 x phi), largest relative difference to "
+    << ( is3D ? "TH3D" : "TH2D" ) << "::Interpolate " << maxdiff;
+  if ( maxdiff > 1.0e-12 ) {
+    LOG("Flux", pWARN)
+      << "Flux grid for " << nu_pdg << " differs from the histogram interpolation by more than 1e-12";
+  }
+
+  fFluxGrid[igrid] = grid;
+}
+
+//_________________________________________________________________________
+
+double GPowerSpectrumAtmoFlux::GridFlux(const FluxGrid& grid, double energy, double logE,
+                                        double costh, double phi) const
+{
+  const double u[3] = { logE, costh, phi };
+  const double x[3] = { energy, costh, phi };
+
+  // lower node and fraction per axis: clamps, one lookup and one compare
+  bool inside = true;
+  double t[3];
+  size_t cell = 0;
+  for ( int a = 0; a < 3; ++a ) {
+    const GridAxis& axis = grid.axis[a];
+    inside = inside & ( u[a] >= axis.lo ) & ( u[a] <= axis.hi );
+    double v = std::min(std::max(u[a],axis.first),axis.last);
+    int k = std::min(int((v-axis.first)*axis.inv),int(axis.cell.size())-1);
+    int i = axis.cell[k];
+    i = std::min(i + int( v >= axis.node[i+1] ),axis.imax);
+    t[a] = std::min(std::max((x[a]-axis.x[i])*axis.invdx[i],0.),1.);
+    cell += i*axis.stride;
+  }
+
+  const double* c = &grid.flux[cell];
+  const size_t d0 = grid.axis[0].step;
+  const size_t d1 = grid.axis[1].step;
+  const size_t d2 = grid.axis[2].step;
+  double c00 = (1-t[2])*c[0]     + t[2]*c[d2];
+  double c01 = (1-t[2])*c[d1]    + t[2]*c[d1+d2];
+  double c10 = (1-t[2])*c[d0]    + t[2]*c[d0+d2];
+  double c11 = (1-t[2])*c[d0+d1] + t[2]*c[d0+d1+d2];
+  double c0  = (1-t[1])*c00 + t[1]*c01;
+  double c1  = (1-t[1])*c10 + t[1]*c11;
+  return inside * ( (1-t[0])*c0 + t[0]*c1 );
+}
+
 //_________________________________________________________________________
 
 double GPowerSpectrumAtmoFlux::GetFlux(int flavour, double energy, double costh, double phi)
 {
+  int igrid = GridIndex(flavour);
+  if ( igrid >= 0 && ! fFluxGrid[igrid].flux.empty() ) {
+    return this->GridFlux(fFluxGrid[igrid], energy, std::log(energy), costh, phi);
+  }
+
   TH3D* flux_hist = nullptr;
   std::map<int,TH3D*>::iterator it = fRawFluxHistoMap.find(flavour);
   if(it != fRawFluxHistoMap.end())
@@ -474,8 +737,6 @@ double GPowerSpectrumAtmoFlux::GetFlux(int flavour, double energy, double costh,
     flux_hist = it->second;
   }
 
-  LOG("Flux", pERROR) << "flux_hist: " << flux_hist;
-
   if(!flux_hist) return 0.0;
 
   if(flux_hist->GetZaxis()->GetNbins() == 1){ //no binning in phi, bilinear interpolation only so using the 2D hist
@@ -491,9 +752,26 @@ double GPowerSpectrumAtmoFlux::GetFlux(int flavour, double energy, double costh,
 
 double GPowerSpectrumAtmoFlux::ComputeWeight(int flavour, double energy, double costh, double phi)
 {
-  double flux = this->GetFlux(flavour, energy, costh, phi);
+  // the power law's density is in fGlobalGenWeight alone
+  double density = ( this->ImportanceSampling() ) ? this->ProposalDensity(flavour, energy, costh) : 1.;
+  return this->WeightFor(flavour, energy, costh, phi, density);
+}
+
+//_________________________________________________________________________
+
+double GPowerSpectrumAtmoFlux::WeightFor(int flavour, double energy, double costh, double phi,
+                                         double density)
+{
+  if ( density <= 0 ) return 0.;
+
+  // one log for both the grid and the power law
+  double logE = std::log(energy);
+  int igrid = GridIndex(flavour);
+  double flux = ( igrid >= 0 && ! fFluxGrid[igrid].flux.empty() )
+    ? this->GridFlux(fFluxGrid[igrid], energy, logE, costh, phi)
+    : this->GetFlux(flavour, energy, costh, phi);
 
-  return flux*fAgen*fGlobalGenWeight*pow(energy, fSpectralIndex);
+  return flux*fAgen*fGlobalGenWeight*std::exp(fSpectralIndex*logE)/density;
 }
 
 //_________________________________________________________________________
@@ -509,4 +787,188 @@ void GPowerSpectrumAtmoFlux::InitializeWeight()
 	double ITheta = 4*kPi;
 
 	fGlobalGenWeight=IE*ITheta;
+
+	// importance sampling: the proposal's normalisation instead
+	if ( fImportanceSampling ) {
+		this->BuildProposal();
+		if ( this->ImportanceSampling() ) {
+			fGlobalGenWeight = 0;
+			for ( size_t icell = 0; icell < fCellDensity.size(); ++icell ) {
+				fGlobalGenWeight += fCellDensity[icell] * 2*kPi * (fCellCosHigh[icell]-fCellCosLow[icell])
+				                  * (fCellB[icell]-fCellA[icell]) / (1.-fSpectralIndex);
+			}
+		}
+	}
+	this->DropBatch();
+}
+
+//_________________________________________________________________________
+
+void GPowerSpectrumAtmoFlux::SetImportanceSampling(bool importance)
+{
+	fImportanceSampling = importance;
+	this->InitializeWeight();
+}
+
+//_________________________________________________________________________
+
+void GPowerSpectrumAtmoFlux::SetQuasiRandom(bool quasi, unsigned long offset, unsigned int scramble_seed)
+{
+	delete fSobol;
+	fSobol = 0;
+	if ( quasi ) {
+		// jobs sharing a scramble seed take blocks of one sequence;
+		// without one the scramble follows the job's seed via RndFlux
+		fSobol = new SobolSequence(6);
+		if ( scramble_seed != 0 ) {
+			TRandom3 scramble(scramble_seed);
+			fSobol->Scramble(scramble);
+		} else {
+			fSobol->Scramble(RandomGen::Instance()->RndFlux());
+		}
+		fSobol->Skip(offset);
+		LOG("Flux", pNOTICE)
+		<< "Quasi-random (scrambled Sobol) Ev, cos8, phi, displacement and proposal cell, "
+		<< "starting at point " << offset;
+	}
+	this->DropBatch();
+}
+
+//_________________________________________________________________________
+
+bool GPowerSpectrumAtmoFlux::ImportanceSampling(void) const
+{
+	return fImportanceSampling && ! fCellDensity.empty();
+}
+
+//_________________________________________________________________________
+
+void GPowerSpectrumAtmoFlux::BuildProposal(void)
+{
+	fCellPdg.clear();
+	fCellA.clear();
+	fCellB.clear();
+	fCellCosLow.clear();
+	fCellCosHigh.clear();
+	fCellDensity.clear();
+	for ( int igrid = 0; igrid < kNGridFlavors; ++igrid ) fProposal[igrid] = ProposalTable();
+
+	const double alpha = fSpectralIndex;
+	map<int,TH3D*>::iterator hist_iter = fRawFluxHistoMap.begin();
+	for ( ; hist_iter != fRawFluxHistoMap.end(); ++hist_iter ) {
+		int nu_pdg = hist_iter->first;
+		int igrid  = GridIndex(nu_pdg);
+		TH3D* h3   = hist_iter->second;
+		if ( igrid < 0 || ! h3 ) continue;
+		const TAxis* eaxis = h3->GetXaxis();
+		const TAxis* caxis = h3->GetYaxis();
+		int ne = eaxis->GetNbins();
+		int nc = caxis->GetNbins();
+		int nphi = h3->GetZaxis()->GetNbins();
+
+		// flux * Ev^alpha at the bin centers, largest over phi
+		vector<double> g(size_t(ne)*nc,0.);
+		for ( int ie = 0; ie < ne; ++ie ) {
+			double scale = TMath::Power(eaxis->GetBinCenter(ie+1),alpha);
+			for ( int ic = 0; ic < nc; ++ic ) {
+				double content = 0;
+				for ( int iphi = 1; iphi <= nphi; ++iphi ) {
+					content = std::max(content,h3->GetBinContent(ie+1,ic+1,iphi));
+				}
+				g[size_t(ie)*nc+ic] = content*scale;
+			}
+		}
+
+		ProposalTable& table = fProposal[igrid];
+		for ( int ie = 0; ie <= ne; ++ie ) table.eedges.push_back(eaxis->GetBinLowEdge(ie+1));
+		for ( int ic = 0; ic <= nc; ++ic ) table.cedges.push_back(caxis->GetBinLowEdge(ic+1));
+		table.density.assign(size_t(ne)*nc,0.);
+		for ( int ie = 0; ie < ne; ++ie ) {
+			// the part of the bin inside [Emin,Emax]
+			double elow  = std::max(table.eedges[ie],fMinEvCut);
+			double ehigh = std::min(table.eedges[ie+1],fMaxEvCut);
+			if ( ehigh <= elow || elow <= 0 ) continue;
+			for ( int ic = 0; ic < nc; ++ic ) {
+				// the interpolated flux in a bin reaches to the next bin centers
+				double d = 0;
+				for ( int je = std::max(ie-1,0); je <= std::min(ie+1,ne-1); ++je ) {
+					for ( int jc = std::max(ic-1,0); jc <= std::min(ic+1,nc-1); ++jc ) {
+						d = std::max(d,g[size_t(je)*nc+jc]);
+					}
+				}
+				double clow  = std::max(table.cedges[ic],-1.);
+				double chigh = std::min(table.cedges[ic+1],1.);
+				if ( d <= 0 || chigh <= clow ) continue;
+				table.density[size_t(ie)*nc+ic] = d;
+				fCellPdg.push_back(nu_pdg);
+				fCellA.push_back(TMath::Power(elow,1.0-alpha));
+				fCellB.push_back(TMath::Power(ehigh,1.0-alpha));
+				fCellCosLow.push_back(clow);
+				fCellCosHigh.push_back(chigh);
+				fCellDensity.push_back(d);
+			}
+		}
+	}
+
+	// Vose's alias table over the cell probabilities
+	size_t ncells = fCellDensity.size();
+	fCellAliasProb.assign(ncells,1.);
+	fCellAlias.resize(ncells);
+	for ( size_t i = 0; i < ncells; ++i ) fCellAlias[i] = i;
+	if ( ncells == 0 ) {
+		if ( ! fRawFluxHistoMap.empty() ) {
+			LOG("Flux", pERROR)
+			<< "No flux in [" << fMinEvCut << "," << fMaxEvCut << "] GeV, importance sampling not used";
+		}
+		return;
+	}
+	vector<double> scaled(ncells);
+	double total = 0;
+	for ( size_t i = 0; i < ncells; ++i ) {
+		scaled[i] = fCellDensity[i] * (fCellCosHigh[i]-fCellCosLow[i]) * (fCellB[i]-fCellA[i]) / (1.-alpha);
+		total += scaled[i];
+	}
+	vector<int> small, large;
+	for ( size_t i = 0; i < ncells; ++i ) {
+		scaled[i] *= ncells / total;
+		if ( scaled[i] < 1. ) small.push_back(i);
+		else                  large.push_back(i);
+	}
+	while ( ! small.empty() && ! large.empty() ) {
+		int is = small.back(); small.pop_back();
+		int il = large.back();
+		fCellAliasProb[is] = scaled[is];
+		fCellAlias[is]     = il;
+		scaled[il] -= ( 1. - scaled[is] );
+		if ( scaled[il] < 1. ) {
+			large.pop_back();
+			small.push_back(il);
+		}
+	}
+	// whatever is left is 1 up to rounding
+	for ( int i : small ) fCellAliasProb[i] = 1.;
+	for ( int i : large ) fCellAliasProb[i] = 1.;
+
+	LOG("Flux", pNOTICE)
+	<< "Importance sampling from the flux tables: " << ncells << " (flavor, Ev, cos8) cells";
+}
+
+//_________________________________________________________________________
+
+double GPowerSpectrumAtmoFlux::ProposalDensity(int flavour, double energy, double costh) const
+{
+	int igrid = GridIndex(flavour);
+	if ( igrid < 0 || energy < fMinEvCut || energy > fMaxEvCut ) return 0.;
+	const ProposalTable& table = fProposal[igrid];
+	if ( table.density.empty() ) return 0.;
+
+	int ie = std::upper_bound(table.eedges.begin(),table.eedges.end(),energy) - table.eedges.begin() - 1;
+	int ic = std::upper_bound(table.cedges.begin(),table.cedges.end(),costh)  - table.cedges.begin() - 1;
+	int ne = table.eedges.size() - 1;
+	int nc = table.cedges.size() - 1;
+	// the upper edges belong to the last bins
+	if ( energy == table.eedges.back() ) ie = ne-1;
+	if ( costh  == table.cedges.back() ) ic = nc-1;
+	if ( ie < 0 || ie >= ne || ic < 0 || ic >= nc ) return 0.;
+	return table.density[size_t(ie)*nc+ic];
 }
\ No newline at end of file
@@ -6,6 +6,36 @@
 \brief   A driver for a power spectrum atmospheric neutrino flux.
 		 Elements extensively reused from GAtmoFlux.
 
+		 LoadFluxData() copies each flavor's flux histogram into a dense
+		 grid (log E x cos8 x phi, one contiguous array per flavor with
+		 the bin centers as nodes) that GetFlux() interpolates without a
+		 bin search: a per-axis lookup table on a uniform (log E for the
+		 energy) spacing finer than the narrowest bin gives the cell.
+		 The result is the TH2D/TH3D::Interpolate one to rounding (1e-12
+		 relative is the tolerance; the largest difference on a check
+		 sample is reported when the grid is built), including the 0
+		 outside the domain those interpolate in.
+
+		 Rays are made kBatchSize at a time into per-quantity arrays and
+		 handed out one by one by GenerateNext().  The random numbers are
+		 drawn in the order one-at-a-time generation would draw them, so
+		 the rays are the same as long as nothing else takes numbers from
+		 RndFlux in between; RndFlux is a batch ahead of the last ray.
+
+		 With SetImportanceSampling(true) the rays come from a proposal
+		 built from the flux tables instead: a (flavor, Ev bin, cos8 bin)
+		 cell with probability D * (its Ev^-alpha integral) * dcos8, D the
+		 largest flux*Ev^alpha in and next to the cell, then Ev ~ Ev^-alpha
+		 and cos8, phi uniform inside it.  The weight is flux / proposal,
+		 and covers all the flavors together: the exposure is the number
+		 of rays, not rays per flavor (ImportanceSampling()).
+
+		 SetQuasiRandom(true, offset, seed) takes Ev, cos8, phi, the
+		 position on the generation disk and the proposal cell (importance
+		 sampling) from a scrambled Sobol sequence (SobolSequence) starting
+		 at point offset.  The scramble comes from seed, or RndFlux if 0;
+		 the flavor choice without importance sampling stays pseudo-random.
+
 \author  Pierre Granger <granger@apc.in2p3.fr>
          APC (CNRS)
 
@@ -21,6 +51,7 @@
 #include "GENIE/Tools/Flux/GAtmoFlux.h"
 #include "GENIE/Framework/ParticleData/PDGCodeList.h"
 #include "TH2D.h"
+#include "nugen/EventGeneratorBase/GENIE/SobolSequence.h"
 
 namespace genie {
 namespace flux {
@@ -57,6 +88,9 @@ public:
 	double GetFlux(int flavour, double energy, double costh, double phi);
 	double ComputeWeight(int flavour, double energy, double costh, double phi);
 	void InitializeWeight();
+	void SetImportanceSampling(bool importance); ///< sample from the flux tables (see above)
+	bool ImportanceSampling(void) const; ///< true if the rays come from the flux table proposal
+	void SetQuasiRandom(bool quasi, unsigned long offset=0, unsigned int scramble_seed=0); ///< Sobol points from offset on (see above)
 
 
 private:
@@ -79,6 +113,74 @@ private:
   	map<int, TH3D*> fRawFluxHistoMap; ///< flux = f(Ev,cos8,phi) for each neutrino species
   	map<int, TH2D*> fRawFluxHistoMap2D; ///< flux = f(Ev,cos8) for each neutrino species
 
+	/// one axis of a FluxGrid, nodes at the bin centers
+	struct GridAxis {
+		int n; ///< nodes
+		int imax; ///< last node that can be the lower one of a cell
+		double first; ///< lookup range in log Ev, cos8 or phi
+		double last;
+		double inv; ///< 1/lookup spacing
+		vector<int> cell; ///< lookup cell -> node at or below its start
+		vector<double> node; ///< log Ev, cos8 or phi of the nodes, then +inf
+		vector<double> x; ///< Ev, cos8 or phi of the nodes (linear in Ev inside a cell, as TH1)
+		vector<double> invdx; ///< 1/(x[i+1]-x[i])
+		double lo; ///< interpolation domain, 0 outside
+		double hi;
+		size_t stride;
+		size_t step; ///< stride, or 0 for a single node
+	};
+	/// flux on the nodes of a (log Ev, cos8, phi) grid, [iE][icos][iphi]
+	struct FluxGrid {
+		GridAxis axis[3];
+		vector<double> flux;
+	};
+	static const int kNGridFlavors = 6;
+	FluxGrid fFluxGrid[kNGridFlavors]; ///< indexed by GridIndex(), empty if not loaded
+
+	/// the importance sampling proposal of one flavor, D on [Ev bin][cos8 bin]
+	struct ProposalTable {
+		vector<double> eedges;
+		vector<double> cedges;
+		vector<double> density; ///< 0 where nothing is generated
+	};
+	bool fImportanceSampling; ///< asked for; used once there is a proposal
+	ProposalTable fProposal[kNGridFlavors]; ///< indexed by GridIndex()
+	vector<int> fCellPdg; ///< proposal cells, all flavors
+	vector<double> fCellA; ///< Ev range as Ev^(1-alpha)
+	vector<double> fCellB;
+	vector<double> fCellCosLow;
+	vector<double> fCellCosHigh;
+	vector<double> fCellDensity; ///< D
+	vector<double> fCellAliasProb; ///< alias table over the cells
+	vector<int> fCellAlias;
+
+	SobolSequence* fSobol; ///< quasi-random Ev, cos8, phi, displacement, cell; 0 = RndFlux
+
+	void BuildProposal(void);
+	double ProposalDensity(int flavour, double energy, double costh) const; ///< D, 0 if not generated there
+	double WeightFor(int flavour, double energy, double costh, double phi, double density);
+
+	static const int kBatchSize = 256; ///< rays generated together
+	int fBatchNext; ///< next ray of the batch GenerateNext() hands out
+	int fBatchFilled; ///< rays in the batch
+	vector<int> fBatchPdg;
+	vector<int> fBatchCell; ///< proposal cell, importance sampling only
+	vector<double> fBatchEv;
+	vector<double> fBatchCosth;
+	vector<double> fBatchPhi;
+	vector<double> fBatchPsi; ///< displacement on the generation surface
+	vector<double> fBatchRadius;
+	vector<double> fBatchWeight;
+	vector<double> fBatchX[3];
+	vector<double> fBatchP[3];
+
+	void GenerateBatch(void);
+	void DropBatch(void); ///< after a change of settings
+
+	static int GridIndex(int nu_pdg); ///< nue, nuebar, numu, numubar, nutau, nutaubar; -1 otherwise
+	void BuildFluxGrid(int nu_pdg);
+	double GridFlux(const FluxGrid& grid, double energy, double logE, double costh, double phi) const;
+
 	bool FillFluxHisto(int nu_pdg, string filename);
 	void AddAllFluxes(void);
 	TH3D* CreateNormalisedFluxHisto( TH3D* hist);  // normalise flux files
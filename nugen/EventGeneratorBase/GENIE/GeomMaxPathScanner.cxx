@@ -0,0 +1,288 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GeomMaxPathScanner.cxx
+/// \brief Multi-threaded maximum path length scan of a ROOT geometry
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#include "TGeoBBox.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TList.h"
+#include "TMath.h"
+
+#ifdef GENIE_PRE_R3
+  #include "GENIE/EVGDrivers/PathLengthList.h"
+  #include "GENIE/PDG/PDGCodeList.h"
+  #include "GENIE/PDG/PDGUtils.h"
+#else
+  #include "GENIE/Framework/EventGen/PathLengthList.h"
+  #include "GENIE/Framework/ParticleData/PDGCodeList.h"
+  #include "GENIE/Framework/ParticleData/PDGUtils.h"
+#endif
+
+#include "nugen/EventGeneratorBase/GENIE/GeomMaxPathScanner.h"
+
+namespace {
+
+  const int    kMaxStuckSteps = 100;   ///< zero length steps before giving up on a ray
+  const size_t kRaysPerChunk  = 1000;  ///< for caller supplied rays
+
+  /// splitmix64: small, fast, and good enough to place rays
+  struct RayRandom {
+    explicit RayRandom(uint64_t seed) : fState(seed) { }
+    uint64_t Next() {
+      uint64_t z = ( fState += 0x9E3779B97F4A7C15ULL );
+      z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+      z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+      return z ^ ( z >> 31 );
+    }
+    double Uniform() { return ( Next() >> 11 ) * ( 1.0 / 9007199254740992.0 ); }
+    uint64_t fState;
+  };
+
+  /// length through each material (indexed by TGeoMaterial::GetIndex())
+  void TraceRay(TGeoNavigator* nav, const double* pos, const double* dir,
+                std::vector<double>& len, std::vector<size_t>& touched)
+  {
+    nav->InitTrack(pos,dir);
+    if ( nav->IsOutside() ) {
+      // started on (or outside) the surface, get in first
+      nav->FindNextBoundaryAndStep();
+      if ( nav->IsOutside() ) return;
+    }
+    int nstuck = 0;
+    while ( ! nav->IsOutside() ) {
+      TGeoNode*     node = nav->GetCurrentNode();
+      TGeoMaterial* mat  = ( node ) ? node->GetVolume()->GetMaterial() : nullptr;
+      nav->FindNextBoundaryAndStep();
+      double step = nav->GetStep();
+      if ( step <= 0 ) {
+        if ( ++nstuck > kMaxStuckSteps ) break;
+        continue;
+      }
+      nstuck = 0;
+      if ( ! mat ) continue;
+      size_t imat = mat->GetIndex();
+      if ( len[imat] == 0 ) touched.push_back(imat);
+      len[imat] += step;
+    }
+  }
+
+}
+
+namespace evgb {
+
+  //--------------------------------------------------
+  GeomMaxPathScanner::GeomMaxPathScanner(TGeoManager* geom, TGeoVolume* topvol,
+                                         genie::PDGCodeList const& targets,
+                                         int nthreads)
+    : fGeom    (geom)
+    , fTopVol  (topvol)
+    , fTargets (targets.begin(),targets.end())
+    , fNThreads(nthreads)
+    , fNRays   (0)
+    , fSeconds (0)
+  {
+    if ( fNThreads <= 0 ) fNThreads = std::thread::hardware_concurrency();
+    if ( fNThreads <= 0 ) fNThreads = 1;
+
+    fMaxPL.assign(fTargets.size(),0.);
+    fMaxRay.resize(fTargets.size());
+
+    // density * mass fraction of each target in each material;
+    // same conventions as ROOTGeomAnalyzer (mixture weights sum to 1)
+    auto addWeight = [this](size_t imat, int pdg, double weight) {
+      auto itgt = std::find(fTargets.begin(),fTargets.end(),pdg);
+      if ( itgt == fTargets.end() || weight <= 0 ) return;
+      size_t jtgt = itgt - fTargets.begin();
+      for ( auto& mw : fMatWeights[imat] ) {
+        if ( mw.first == jtgt ) { mw.second += weight; return; }
+      }
+      fMatWeights[imat].push_back(std::make_pair(jtgt,weight));
+    };
+
+    TList* materials = fGeom->GetListOfMaterials();
+    fMatWeights.resize(materials->GetSize());
+    TIter next(materials);
+    while ( TGeoMaterial* mat = dynamic_cast<TGeoMaterial*>(next()) ) {
+      // also sets the cached index before any threads ask for it
+      size_t imat = mat->GetIndex();
+      if ( imat >= fMatWeights.size() ) fMatWeights.resize(imat+1);
+      double density = mat->GetDensity();
+      if ( mat->IsMixture() ) {
+        TGeoMixture* mixt = static_cast<TGeoMixture*>(mat);
+        double wsum = 0;
+        for ( int i = 0; i < mixt->GetNelements(); ++i ) wsum += mixt->GetWmixt()[i];
+        if ( wsum <= 0 ) continue;
+        for ( int i = 0; i < mixt->GetNelements(); ++i ) {
+          int pdg = genie::pdg::IonPdgCode(TMath::Nint(mixt->GetAmixt()[i]),
+                                           TMath::Nint(mixt->GetZmixt()[i]));
+          addWeight(imat,pdg,density*mixt->GetWmixt()[i]/wsum);
+        }
+      } else {
+        int pdg = genie::pdg::IonPdgCode(TMath::Nint(mat->GetA()),
+                                         TMath::Nint(mat->GetZ()));
+        addWeight(imat,pdg,density);
+      }
+    }
+  }
+
+  //--------------------------------------------------
+  void GeomMaxPathScanner::ScanBox(int npoints, int nrays, unsigned long int seed)
+  {
+    TGeoBBox* bbox = dynamic_cast<TGeoBBox*>(fTopVol->GetShape());
+    if ( ! bbox || npoints <= 0 || nrays <= 0 ) return;
+    const double  half[3] = { bbox->GetDX(), bbox->GetDY(), bbox->GetDZ() };
+    const double* origin  = bbox->GetOrigin();
+
+    // chunk = one point on one of the 6 faces, with all its rays
+    size_t nchunks = 6 * static_cast<size_t>(npoints);
+    Run(nchunks,[&](size_t ichunk, std::vector<Ray>& rays) {
+        RayRandom rnd(seed*0x100000001B3ULL + ichunk);
+        int    face = ichunk / npoints;
+        int    axis = face / 2;
+        double side = ( face % 2 ) ? 1. : -1.;
+
+        double pos[3];
+        for ( int i = 0; i < 3; ++i ) {
+          pos[i] = origin[i] + half[i] * ( ( i == axis ) ? side : 2.*rnd.Uniform()-1. );
+        }
+        int u = ( axis + 1 ) % 3;
+        int v = ( axis + 2 ) % 3;
+        for ( int iray = 0; iray < nrays; ++iray ) {
+          // isotropic into the box
+          double costh = rnd.Uniform();
+          double sinth = std::sqrt(std::max(0.,1.-costh*costh));
+          double phi   = 2.*TMath::Pi()*rnd.Uniform();
+          Ray ray;
+          std::copy(pos,pos+3,ray.pos);
+          ray.dir[axis] = -side * costh;
+          ray.dir[u]    = sinth * std::cos(phi);
+          ray.dir[v]    = sinth * std::sin(phi);
+          rays.push_back(ray);
+        }
+      });
+  }
+
+  //--------------------------------------------------
+  void GeomMaxPathScanner::ScanRays(std::vector<TVector3> const& pos,
+                                    std::vector<TVector3> const& dir)
+  {
+    size_t n = std::min(pos.size(),dir.size());
+    size_t nchunks = ( n + kRaysPerChunk - 1 ) / kRaysPerChunk;
+    Run(nchunks,[&](size_t ichunk, std::vector<Ray>& rays) {
+        size_t last = std::min(n,(ichunk+1)*kRaysPerChunk);
+        for ( size_t i = ichunk*kRaysPerChunk; i < last; ++i ) {
+          TVector3 udir = dir[i].Unit();
+          Ray ray;
+          pos[i].GetXYZ(ray.pos);
+          udir.GetXYZ(ray.dir);
+          rays.push_back(ray);
+        }
+      });
+  }
+
+  //--------------------------------------------------
+  void GeomMaxPathScanner::Run(size_t nchunks, RayFunc_t makeRays)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    TGeoVolume* oldTop = fGeom->GetTopVolume();
+    if ( oldTop != fTopVol ) fGeom->SetTopVolume(fTopVol);
+    // per-thread navigators (and shape data) need this
+    if ( fGeom->GetMaxThreads() < fNThreads ) fGeom->SetMaxThreads(fNThreads);
+
+    struct Partial {
+      std::vector<double> maxpl;
+      std::vector<Ray>    maxray;
+      long int            nrays = 0;
+    };
+    std::vector<Partial>     partials(fNThreads);
+    std::atomic<size_t>      nextChunk(0);
+    std::vector<std::thread> threads;
+    size_t ntgt = fTargets.size();
+    size_t nmat = fMatWeights.size();
+
+    for ( int ithread = 0; ithread < fNThreads; ++ithread ) {
+      threads.emplace_back([&,ithread]() {
+          Partial& part = partials[ithread];
+          part.maxpl.assign(ntgt,0.);
+          part.maxray.resize(ntgt);
+
+          TGeoNavigator* nav = fGeom->AddNavigator();
+          std::vector<double> len(nmat,0.);
+          std::vector<size_t> touched;
+          std::vector<double> pl(ntgt,0.);
+          std::vector<Ray>    rays;
+
+          size_t ichunk;
+          while ( ( ichunk = nextChunk.fetch_add(1) ) < nchunks ) {
+            rays.clear();
+            makeRays(ichunk,rays);
+            for ( Ray const& ray : rays ) {
+              TraceRay(nav,ray.pos,ray.dir,len,touched);
+              std::fill(pl.begin(),pl.end(),0.);
+              for ( size_t imat : touched ) {
+                for ( auto const& mw : fMatWeights[imat] ) pl[mw.first] += len[imat]*mw.second;
+                len[imat] = 0;
+              }
+              touched.clear();
+              for ( size_t itgt = 0; itgt < ntgt; ++itgt ) {
+                if ( pl[itgt] > part.maxpl[itgt] ) {
+                  part.maxpl[itgt]  = pl[itgt];
+                  part.maxray[itgt] = ray;
+                }
+              }
+            }
+            part.nrays += rays.size();
+          }
+          fGeom->RemoveNavigator(nav);
+        });
+    }
+    for ( auto& thread : threads ) thread.join();
+
+    for ( Partial const& part : partials ) {
+      fNRays += part.nrays;
+      for ( size_t itgt = 0; itgt < ntgt; ++itgt ) {
+        if ( part.maxpl[itgt] > fMaxPL[itgt] ) {
+          fMaxPL[itgt]  = part.maxpl[itgt];
+          fMaxRay[itgt] = part.maxray[itgt];
+        }
+      }
+    }
+
+    if ( oldTop != fTopVol ) fGeom->SetTopVolume(oldTop);
+    fSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  }
+
+  //--------------------------------------------------
+  void GeomMaxPathScanner::FillMaxPathLengths(genie::PathLengthList& pl) const
+  {
+    for ( size_t itgt = 0; itgt < fTargets.size(); ++itgt ) {
+      pl.SetPathLength(fTargets[itgt],fMaxPL[itgt]);
+    }
+  }
+
+  //--------------------------------------------------
+  bool GeomMaxPathScanner::LongestRay(TVector3& pos, TVector3& dir, int& pdg) const
+  {
+    auto imax = std::max_element(fMaxPL.begin(),fMaxPL.end());
+    if ( imax == fMaxPL.end() || *imax <= 0 ) return false;
+    size_t itgt = imax - fMaxPL.begin();
+    pos.SetXYZ(fMaxRay[itgt].pos[0],fMaxRay[itgt].pos[1],fMaxRay[itgt].pos[2]);
+    dir.SetXYZ(fMaxRay[itgt].dir[0],fMaxRay[itgt].dir[1],fMaxRay[itgt].dir[2]);
+    pdg = fTargets[itgt];
+    return true;
+  }
+
+} // namespace evgb
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GeomMaxPathScanner.h
+/// \class evgb::GeomMaxPathScanner
+/// \brief Multi-threaded replacement for ROOTGeomAnalyzer's serial
+///        maximum path length scans ("box" and "flux" GeomScan methods)
+///
+///        Rays are traced through the shared TGeoManager by several
+///        threads, each with its own TGeoNavigator.  Every ray gives
+///        the length traversed in each material; these are turned into
+///        density weighted path lengths per target nucleus and the
+///        maximum over all rays is kept.  Work is split into fixed
+///        chunks (seeded by chunk number for the box scan) so the result
+///        does not depend on the number of threads.
+///
+///        Positions, directions and results are in the geometry's own
+///        units and top volume coordinates (as ROOTGeomAnalyzer uses
+///        internally); use ROOTGeomAnalyzer::Local2SI() on the result.
+///        A fiducial volume selector is not applied, so with one the
+///        result can only be larger than GENIE's (i.e. still safe).
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_GEOMMAXPATHSCANNER_H
+#define EVGB_GEOMMAXPATHSCANNER_H
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "TVector3.h"
+
+class TGeoManager;
+class TGeoVolume;
+
+namespace genie {
+  class PDGCodeList;
+  class PathLengthList;
+}
+
+namespace evgb {
+
+  class GeomMaxPathScanner {
+
+  public:
+
+    /// nthreads <= 0 means one per hardware thread
+    GeomMaxPathScanner(TGeoManager* geom, TGeoVolume* topvol,
+                       genie::PDGCodeList const& targets, int nthreads);
+
+    /// "npoints" points on each face of the top volume's bounding box,
+    /// "nrays" random inward directions from each
+    void ScanBox(int npoints, int nrays, unsigned long int seed);
+
+    /// rays given by the caller (top volume coordinates, geometry units)
+    void ScanRays(std::vector<TVector3> const& pos,
+                  std::vector<TVector3> const& dir);
+
+    /// maximum path length for each target (unscaled, geometry units)
+    void FillMaxPathLengths(genie::PathLengthList& pl) const;
+
+    /// ray that gave the largest path length for any single target
+    bool LongestRay(TVector3& pos, TVector3& dir, int& pdg) const;
+
+    int      NThreads() const { return fNThreads; }
+    long int NRays()    const { return fNRays;    }
+    double   Seconds()  const { return fSeconds;  }
+
+  private:
+
+    struct Ray { double pos[3]; double dir[3]; };
+
+    /// fill the rays for one chunk of work
+    typedef std::function<void(size_t, std::vector<Ray>&)> RayFunc_t;
+
+    void Run(size_t nchunks, RayFunc_t makeRays);
+
+    TGeoManager*        fGeom;
+    TGeoVolume*         fTopVol;
+    std::vector<int>    fTargets;   ///< pdg codes of the target nuclei
+    /// per material index: (target index, density * mass fraction)
+    std::vector< std::vector< std::pair<size_t,double> > > fMatWeights;
+    int                 fNThreads;
+
+    std::vector<double> fMaxPL;     ///< per target
+    std::vector<Ray>    fMaxRay;    ///< per target
+    long int            fNRays;
+    double              fSeconds;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_GEOMMAXPATHSCANNER_H
@@ -0,0 +1,124 @@
+#include <algorithm>
+
+#include <TRandom3.h>
+
+#include "nugen/EventGeneratorBase/GENIE/SobolSequence.h"
+
+using namespace genie::flux;
+
+namespace {
+	// Joe & Kuo (new-joe-kuo-6.21201), dimensions 2 and up: degree s,
+	// polynomial a and the initial m_1..m_s; dimension 1 has all m = 1
+	struct Primitive { unsigned int s; unsigned int a; unsigned int m[5]; };
+	const Primitive kPrimitives[SobolSequence::kMaxDimensions-1] = {
+		{ 1, 0, { 1 } },
+		{ 2, 1, { 1, 3 } },
+		{ 3, 1, { 1, 3, 1 } },
+		{ 3, 2, { 1, 1, 1 } },
+		{ 4, 1, { 1, 1, 3, 3 } },
+		{ 4, 4, { 1, 3, 5, 13 } },
+		{ 5, 2, { 1, 1, 5, 5, 17 } }
+	};
+
+	unsigned int Parity(unsigned int v)
+	{
+		v ^= v >> 16;
+		v ^= v >> 8;
+		v ^= v >> 4;
+		v ^= v >> 2;
+		v ^= v >> 1;
+		return v & 1u;
+	}
+}
+
+//________________________________________________________________________________________
+
+SobolSequence::SobolSequence(unsigned int ndim)
+  : fNDim(std::min(std::max(ndim,1u),kMaxDimensions))
+  , fIndex(0)
+  , fDirection(fNDim,std::vector<unsigned int>(kBits,0))
+  , fShift(fNDim,0)
+  , fState(fNDim,0)
+{
+	// V_k = m_k 2^(32-k), then the recurrence of the primitive polynomial
+	for ( unsigned int k = 0; k < kBits; ++k ) fDirection[0][k] = 1u << (kBits-1-k);
+	for ( unsigned int idim = 1; idim < fNDim; ++idim ) {
+		const Primitive& p = kPrimitives[idim-1];
+		std::vector<unsigned int>& v = fDirection[idim];
+		for ( unsigned int k = 0; k < kBits; ++k ) {
+			if ( k < p.s ) {
+				v[k] = p.m[k] << (kBits-1-k);
+				continue;
+			}
+			v[k] = v[k-p.s] ^ ( v[k-p.s] >> p.s );
+			for ( unsigned int i = 1; i < p.s; ++i ) {
+				if ( ( p.a >> (p.s-1-i) ) & 1u ) v[k] ^= v[k-i];
+			}
+		}
+	}
+}
+
+//________________________________________________________________________________________
+
+void SobolSequence::Scramble(TRandom3& rnd)
+{
+	for ( unsigned int idim = 0; idim < fNDim; ++idim ) {
+		// lower triangular with a unit diagonal: bit j (from the top) of
+		// the output mixes in the more significant input bits at random
+		unsigned int rows[kBits];
+		for ( unsigned int j = 0; j < kBits; ++j ) {
+			unsigned int row = 1u << (kBits-1-j);
+			for ( unsigned int i = 0; i < j; ++i ) {
+				if ( rnd.Rndm() < 0.5 ) row |= 1u << (kBits-1-i);
+			}
+			rows[j] = row;
+		}
+		for ( unsigned int k = 0; k < kBits; ++k ) {
+			unsigned int v = fDirection[idim][k];
+			unsigned int scrambled = 0;
+			for ( unsigned int j = 0; j < kBits; ++j ) {
+				scrambled |= Parity(rows[j] & v) << (kBits-1-j);
+			}
+			fDirection[idim][k] = scrambled;
+		}
+		unsigned int shift = 0;
+		for ( unsigned int j = 0; j < kBits; ++j ) {
+			if ( rnd.Rndm() < 0.5 ) shift |= 1u << j;
+		}
+		fShift[idim] = shift;
+	}
+	this->Skip(fIndex);
+}
+
+//________________________________________________________________________________________
+
+void SobolSequence::Skip(unsigned long index)
+{
+	// the point is the XOR of the direction numbers of the Gray code bits
+	fIndex = index;
+	unsigned long gray = index ^ ( index >> 1 );
+	for ( unsigned int idim = 0; idim < fNDim; ++idim ) {
+		unsigned int x = 0;
+		for ( unsigned int k = 0; k < kBits; ++k ) {
+			if ( ( gray >> k ) & 1ul ) x ^= fDirection[idim][k];
+		}
+		fState[idim] = x;
+	}
+}
+
+//________________________________________________________________________________________
+
+void SobolSequence::Next(double* point)
+{
+	const double scale = 1.0/4294967296.0; // 2^-32
+	for ( unsigned int idim = 0; idim < fNDim; ++idim ) {
+		point[idim] = ( fState[idim] ^ fShift[idim] ) * scale;
+	}
+
+	// Gray code order: the next point differs by the direction number
+	// of the lowest zero bit of the index
+	unsigned int c = 0;
+	for ( unsigned long i = fIndex; ( i & 1ul ) && c+1 < kBits; i >>= 1 ) ++c;
+	for ( unsigned int idim = 0; idim < fNDim; ++idim ) fState[idim] ^= fDirection[idim][c];
+	++fIndex;
+}
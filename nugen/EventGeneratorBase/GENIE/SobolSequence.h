@@ -0,0 +1,50 @@
+//____________________________________________________________________________
+/*!
+
+\class   genie::flux::SobolSequence
+
+\brief   A scrambled Sobol low-discrepancy sequence in a few dimensions
+         (direction numbers of Joe & Kuo, up to kMaxDimensions).
+         Scramble() applies a random linear (Matousek) scramble and a
+         digital shift per dimension, which keeps the stratification of
+         the points; Skip() starts the sequence at any index, so jobs can
+         take consecutive blocks of one sequence.
+
+\created October 16, 2026
+
+*/
+//____________________________________________________________________________
+
+#pragma once
+
+#include <vector>
+
+class TRandom3;
+
+namespace genie {
+namespace flux {
+
+class SobolSequence {
+public:
+	static constexpr unsigned int kMaxDimensions = 8;
+	static constexpr unsigned int kBits = 32;
+
+	SobolSequence(unsigned int ndim);
+
+	void Scramble(TRandom3& rnd); ///< new scramble and shift, from rnd
+	void Skip(unsigned long index); ///< the next point is the one at index
+	void Next(double* point); ///< NDimensions() values in [0,1)
+
+	unsigned int NDimensions(void) const { return fNDim; }
+	unsigned long Index(void) const { return fIndex; }
+
+private:
+	unsigned int fNDim;
+	unsigned long fIndex; ///< of the next point
+	std::vector< std::vector<unsigned int> > fDirection; ///< [dim][bit], scrambled
+	std::vector<unsigned int> fShift; ///< [dim]
+	std::vector<unsigned int> fState; ///< [dim], point at fIndex before the shift
+};
+
+} // flux namespace
+} // genie namespace
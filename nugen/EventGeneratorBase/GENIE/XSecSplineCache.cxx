@@ -0,0 +1,282 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  XSecSplineCache.cxx
+/// \brief Node-local cache of GENIE cross section spline files
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+#include "nugen/EventGeneratorBase/GENIE/XSecSplineCache.h"
+#include "nugen/EventGeneratorBase/GENIE/EVGBCacheUtil.h"
+
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+namespace {
+
+  const char kXmlDecl[]     = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n";
+  const char kHeaderStart[] = "<!-- evgb::XSecSplineCache ";
+  const char kHeaderEnd[]   = " -->\n";
+  const char kRootTag[]     = "<genie_xsec_spline_list";
+  const char kRootClose[]   = "</genie_xsec_spline_list>";
+
+  bool StartsWith(const char* p, const char* end, const char* s)
+  {
+    size_t n = std::strlen(s);
+    return ( static_cast<size_t>(end-p) >= n ) && std::strncmp(p,s,n) == 0;
+  }
+
+  const char* Find(const char* p, const char* end, const char* s)
+  {
+    const char* r = std::search(p,end,s,s+std::strlen(s));
+    return ( r == end ) ? nullptr : r;
+  }
+
+  bool IsSpace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  /// copy tags and (trimmed) text, dropping comments and <?...?>
+  bool CompactRange(const char* p, const char* end, std::string& out)
+  {
+    while ( p < end ) {
+      const char* lt = static_cast<const char*>(std::memchr(p,'<',end-p));
+      const char* textEnd = ( lt ) ? lt : end;
+
+      // text between tags, without leading/trailing whitespace
+      const char* t0 = p;
+      const char* t1 = textEnd;
+      while ( t0 < t1 && IsSpace(*t0)     ) ++t0;
+      while ( t1 > t0 && IsSpace(*(t1-1)) ) --t1;
+      out.append(t0,t1-t0);
+      if ( ! lt ) break;
+
+      if ( StartsWith(lt,end,"<!--") ) {
+        const char* cend = Find(lt,end,"-->");
+        if ( ! cend ) return false;
+        p = cend + 3;
+        continue;
+      }
+      const char* gt = static_cast<const char*>(std::memchr(lt,'>',end-lt));
+      if ( ! gt ) return false;
+      if ( lt[1] != '?' ) out.append(lt,gt+1-lt);
+      p = gt + 1;
+    }
+    return true;
+  }
+
+  std::string AttributeValue(const char* tag, const char* tagEnd, const char* attr)
+  {
+    std::string pattern = std::string(" ") + attr + "=\"";
+    const char* a = Find(tag,tagEnd,pattern.c_str());
+    if ( ! a ) return "";
+    a += pattern.size();
+    const char* q = static_cast<const char*>(std::memchr(a,'"',tagEnd-a));
+    if ( ! q ) return "";
+    return std::string(a,q-a);
+  }
+
+  /// value of "name=" in the header line (up to the next space)
+  std::string HeaderField(std::string const& header, std::string const& name)
+  {
+    size_t pos = header.find(" "+name+"=");
+    if ( pos == std::string::npos ) return "";
+    pos += name.size() + 2;
+    size_t stop = header.find(' ',pos);
+    return header.substr(pos,stop-pos);
+  }
+
+}
+
+namespace evgb {
+
+  //--------------------------------------------------
+  XSecSplineCache::XSecSplineCache(std::string const& cacheDir)
+    : fCacheDir(cacheDir)
+  {
+    while ( fCacheDir.size() > 1 && fCacheDir.back() == '/' ) fCacheDir.pop_back();
+  }
+
+  //--------------------------------------------------
+  std::string XSecSplineCache::MakeKey(std::string const& xsecTable,
+                                       std::string const& tuneName,
+                                       std::string const& evtGenList,
+                                       std::string const& extra) const
+  {
+    // spline files are hundreds of MB, so go by where the file is and
+    // when it was written rather than reading it all on every job
+    struct stat sb;
+    if ( stat(xsecTable.c_str(),&sb) != 0 ) return "";
+    int64_t stamp[3] = { static_cast<int64_t>(sb.st_size),
+                         static_cast<int64_t>(sb.st_mtim.tv_sec),
+                         static_cast<int64_t>(sb.st_mtim.tv_nsec) };
+    uint64_t hash = evgb::util::HashString(xsecTable);
+    hash = evgb::util::HashBytes(stamp,sizeof(stamp),hash);
+    hash = evgb::util::HashString(tuneName,hash);
+    hash = evgb::util::HashString(evtGenList,hash);
+    hash = evgb::util::HashString(extra,hash);
+    return evgb::util::HashToHex(hash);
+  }
+
+  //--------------------------------------------------
+  std::string XSecSplineCache::CachePath(std::string const& key) const
+  {
+    return fCacheDir + "/gxspl-" + key + ".xml";
+  }
+
+  //--------------------------------------------------
+  std::string XSecSplineCache::Lookup(std::string const& key) const
+  {
+    if ( key == "" ) return "";
+    std::string path = CachePath(key);
+    if ( ! IsValid(path,key) ) return "";
+    return path;
+  }
+
+  //--------------------------------------------------
+  bool XSecSplineCache::KeyPdg(std::string const& splineName,
+                               std::string const& tag, int& pdg)
+  {
+    std::string field = tag + ":";
+    size_t pos = splineName.find(field);
+    // must start a field, i.e. follow the algorithm name or another field
+    while ( pos != std::string::npos && pos > 0 &&
+            splineName[pos-1] != '/' && splineName[pos-1] != ';' ) {
+      pos = splineName.find(field,pos+1);
+    }
+    if ( pos == std::string::npos ) return false;
+    const char* start = splineName.c_str() + pos + field.size();
+    char* stop = nullptr;
+    long int val = std::strtol(start,&stop,10);
+    if ( stop == start ) return false;
+    pdg = static_cast<int>(val);
+    return true;
+  }
+
+  //--------------------------------------------------
+  bool XSecSplineCache::IsValid(std::string const& path, std::string const& key)
+  {
+    // only the header line and the end of the file are read; a complete
+    // entry has the size recorded in its header and ends with the root tag
+    std::ifstream in(path.c_str(),std::ios::binary);
+    if ( ! in ) return false;
+
+    std::string decl, header;
+    if ( ! std::getline(in,decl) || decl+"\n" != kXmlDecl ) return false;
+    if ( ! std::getline(in,header) ) return false;
+    header += "\n";
+    const char* hp   = header.c_str();
+    const char* hend = hp + header.size();
+    if ( ! StartsWith(hp,hend,kHeaderStart) ||
+         header.size() < std::strlen(kHeaderEnd) ||
+         header.compare(header.size()-std::strlen(kHeaderEnd),
+                        std::string::npos,kHeaderEnd) != 0 ) return false;
+    std::streamoff bodyStart = in.tellg();
+
+    if ( HeaderField(header,"key") != key ) return false;
+
+    in.seekg(0,std::ios::end);
+    std::streamoff fileSize = in.tellg();
+    std::ostringstream nbytes;
+    nbytes << (fileSize-bodyStart);
+    if ( HeaderField(header,"bytes") != nbytes.str() ) {
+      mf::LogWarning("XSecSplineCache") << "truncated cache entry " << path;
+      return false;
+    }
+
+    size_t nclose = std::strlen(kRootClose);
+    std::string tail(nclose,' ');
+    if ( fileSize-bodyStart < static_cast<std::streamoff>(nclose) ||
+         ! in.seekg(fileSize-nclose) ||
+         ! in.read(&tail[0],nclose) || tail != kRootClose ) {
+      mf::LogWarning("XSecSplineCache") << "corrupt cache entry " << path;
+      return false;
+    }
+    return true;
+  }
+
+  //--------------------------------------------------
+  std::string XSecSplineCache::Build(std::string const& key,
+                                     std::string const& xsecTable,
+                                     SplineFilter_t     filter) const
+  {
+    if ( key == "" ) return "";
+
+    std::string body;
+    size_t nkept = 0, ndropped = 0;
+    {
+      evgb::util::MappedFile mfile(xsecTable);
+      if ( ! mfile.IsOpen() ||
+           ! Compact(mfile.Data(),mfile.Size(),body,filter,nkept,ndropped) ) {
+        mf::LogWarning("XSecSplineCache")
+          << "could not convert " << xsecTable << ", not caching it";
+        return "";
+      }
+    }
+
+    std::ostringstream entry;
+    entry << kXmlDecl << kHeaderStart
+          << "key=" << key
+          << " splines=" << nkept
+          << " bytes=" << body.size()
+          << kHeaderEnd
+          << body;
+
+    std::string path = CachePath(key);
+    if ( ! evgb::util::AtomicWriteFile(path,entry.str()) ) {
+      mf::LogWarning("XSecSplineCache") << "could not write " << path;
+      return "";
+    }
+    mf::LogInfo("XSecSplineCache")
+      << "cached " << nkept << " splines (" << ndropped << " not needed)"
+      << " from " << xsecTable << " as " << path;
+    return path;
+  }
+
+  //--------------------------------------------------
+  bool XSecSplineCache::Compact(const char* data, size_t len, std::string& body,
+                                SplineFilter_t filter,
+                                size_t& nkept, size_t& ndropped)
+  {
+    const char* end = data + len;
+    const char* p   = Find(data,end,kRootTag);
+    if ( ! p ) return false;
+
+    body.clear();
+    body.reserve(len/2);
+    nkept = ndropped = 0;
+
+    // spline blocks are handled one by one, everything else is copied
+    while ( p < end ) {
+      const char* spl = Find(p,end,"<spline ");
+      const char* blockStart = ( spl ) ? spl : end;
+      if ( ! CompactRange(p,blockStart,body) ) return false;
+      if ( ! spl ) break;
+
+      const char* tagEnd = static_cast<const char*>(std::memchr(spl,'>',end-spl));
+      const char* splEnd = Find(spl,end,"</spline>");
+      if ( ! tagEnd || ! splEnd ) return false;
+      splEnd += std::strlen("</spline>");
+
+      if ( filter && ! filter(AttributeValue(spl,tagEnd,"name")) ) {
+        ++ndropped;
+      } else {
+        if ( ! CompactRange(spl,splEnd,body) ) return false;
+        ++nkept;
+      }
+      p = splEnd;
+    }
+
+    // must have come out as a complete document
+    size_t nclose = std::strlen(kRootClose);
+    return body.size() >= nclose &&
+      body.compare(body.size()-nclose,nclose,kRootClose) == 0;
+  }
+
+} // namespace evgb
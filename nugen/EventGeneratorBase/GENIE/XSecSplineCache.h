@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  XSecSplineCache.h
+/// \class evgb::XSecSplineCache
+/// \brief Node-local cache of GENIE cross section spline files
+///
+///        Cache entries are keyed by the path, size and modification time
+///        of the XSecTable file together with the tune, the event generator list (and
+///        anything else the caller folds in).  The first job on a node
+///        writes a compacted copy of the spline file (no comments, no
+///        indentation, optionally only the splines a job can use) and
+///        later jobs load that instead of the original.
+///
+///        GENIE's XSecSplineList can only be filled by LoadFromXml(), so
+///        entries are still GENIE-schema XML; a header line records the
+///        key and size of the body and an entry is only used if both
+///        check out and the body ends with the closing root tag (writes
+///        go through a rename, so that catches truncated copies).
+///        Otherwise the caller simply falls back to the original file.
+///
+////////////////////////////////////////////////////////////////////////
+
+#ifndef EVGB_XSECSPLINECACHE_H
+#define EVGB_XSECSPLINECACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace evgb {
+
+  class XSecSplineCache {
+
+  public:
+
+    /// return true to keep the spline with this name (GENIE spline key)
+    typedef std::function<bool(std::string const&)> SplineFilter_t;
+
+    explicit XSecSplineCache(std::string const& cacheDir);
+
+    /// key for a spline file + configuration ("" if the file can't be read)
+    std::string MakeKey(std::string const& xsecTable,
+                        std::string const& tuneName,
+                        std::string const& evtGenList,
+                        std::string const& extra = "") const;
+
+    std::string CachePath(std::string const& key) const;
+
+    /// path of a valid entry for this key, "" if missing/stale/corrupt
+    std::string Lookup(std::string const& key) const;
+
+    /// write the entry for this key from the original file; returns its
+    /// path or "" on failure (nothing usable left behind)
+    std::string Build(std::string const& key,
+                      std::string const& xsecTable,
+                      SplineFilter_t     filter = nullptr) const;
+
+    /// pdg code from a "tag:pdg;" field of a GENIE spline key, e.g.
+    /// KeyPdg(".../nu:14;tgt:1000180400;...","tgt",pdg)
+    static bool KeyPdg(std::string const& splineName,
+                       std::string const& tag, int& pdg);
+
+    /// whether the file at "path" is a complete entry for "key"
+    static bool IsValid(std::string const& path, std::string const& key);
+
+    /// strip a GENIE spline XML document down (see class description);
+    /// returns false if it doesn't look like a spline list
+    static bool Compact(const char* data, size_t len, std::string& body,
+                        SplineFilter_t filter,
+                        size_t& nkept, size_t& ndropped);
+
+  private:
+
+    std::string fCacheDir;
+  };
+
+} // namespace evgb
+
+#endif //EVGB_XSECSPLINECACHE_H
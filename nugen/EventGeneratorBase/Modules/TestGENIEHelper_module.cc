@@ -30,6 +30,8 @@
 
 #include "nugen/EventGeneratorBase/evgenbase.h"
 #include "nugen/EventGeneratorBase/GENIE/GENIEHelper.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxReadAhead.h"
+#include "nugen/EventGeneratorBase/GENIE/GFluxEnergyWindow.h"
 
 #include "nugen/EventGeneratorBase/GENIE/EVGBAssociationUtil.h"
 
@@ -143,6 +145,7 @@ namespace evgen {
     fStopwatch.Stop();
     mf::LogInfo("TestGENIEHelper") << "real time to produce file: "
                             << fStopwatch.RealTime();
+    // (per-stage GENIE timing is reported by GENIEHelper itself, see StatsFile)
     delete fGENIEHelp; // clean up, and let dtor do its thing
   }
 
@@ -220,9 +223,6 @@ namespace evgen {
     std::unique_ptr< art::Assns<simb::MCTruth, simb::MCFlux> > assns(new art::Assns<simb::MCTruth, simb::MCFlux>);
 
     std::cerr << " ******************************* TestGENIEHelper::produce() " << std::endl << std::flush;
-    std::cout << " stopwatch at produce() ";
-    fStopwatch.Print("um"); fStopwatch.Continue();
-    std::cout << std::flush;
 
     //--- Dk2Nu additions
     //--- BEGIN
@@ -237,85 +237,72 @@ namespace evgen {
        nuchoiceassn(new art::Assns<simb::MCTruth, bsim::NuChoice>);
     //--- END
 
-    while ( ! fGENIEHelp->Stop() ) {
-
-      simb::MCTruth truth;
-      simb::MCFlux  flux;
-      simb::GTruth  gTruth;
-
-      std::cerr << " *** TestGENIEHelper::produce() about to sample "
-                << truthcol->size()
-                << std::endl << std::flush;
-      std::cout << " stopwatch before Sample() ";
-      fStopwatch.Print("um"); fStopwatch.Continue();
-      std::cout << std::flush;
-
-
-      // GENIEHelper returns a false in the sample method if
-      // either no neutrino was generated, or the interaction
-      // occurred beyond the detector's z extent - ie something we
-      // would never see anyway.
-      if ( fGENIEHelp->Sample(truth, flux, gTruth ) ) {
-
-        std::cout << " stopwatch after Sample() ";
-        fStopwatch.Print("um"); fStopwatch.Continue();
-        std::cout << std::flush;
-
-        truthcol ->push_back(truth);
-        gtruthcol->push_back(gTruth);
-        fluxcol  ->push_back(flux);
-
-        evgb::util::CreateAssn(*this, evt, *truthcol, *fluxcol, *assns,
-                         fluxcol->size()-1, fluxcol->size());
-
-        evgb::util::CreateAssn(*this, evt, *truthcol, *gtruthcol, *tgtassn,
-                         gtruthcol->size()-1, gtruthcol->size());
-
-        //--- Dk2Nu additions
-        //--- BEGIN
-        genie::GFluxI* fdriver = fGENIEHelp->GetFluxDriver(true);
+    // called for each new entry while the flux driver still holds its ray
+    auto onEvent = [&](size_t indx) {
+
+      evgb::util::CreateAssn(*this, evt, *truthcol, *fluxcol, *assns,
+                             indx, indx+1, indx);
+
+      evgb::util::CreateAssn(*this, evt, *truthcol, *gtruthcol, *tgtassn,
+                             indx, indx+1, indx);
+
+      //--- Dk2Nu additions
+      //--- BEGIN
+      genie::GFluxI* fdriver = fGENIEHelp->GetFluxDriver(true);
+      const bsim::Dk2Nu*    dk2nuPtr    = 0;
+      const bsim::NuChoice* nuchoicePtr = 0;
+      evgb::GFluxReadAhead* readahead =
+        dynamic_cast<evgb::GFluxReadAhead*>(fdriver);
+      if ( readahead ) {
+        // the real driver is rays ahead, use the copies of this one's
+        dk2nuPtr    = readahead->GetDk2Nu();
+        nuchoicePtr = readahead->GetNuChoice();
+      } else {
+        // an energy window leaves the real driver on the current ray
+        evgb::GFluxEnergyWindow* window =
+          dynamic_cast<evgb::GFluxEnergyWindow*>(fdriver);
+        if ( window ) fdriver = window->GetFluxGenerator();
         genie::flux::GDk2NuFlux* dk2nuDriver =
           dynamic_cast<genie::flux::GDk2NuFlux*>(fdriver);
         if ( dk2nuDriver ) {
-          const bsim::Dk2Nu& dk2nuObj = dk2nuDriver->GetDk2Nu();
-          dk2nucol   ->push_back(dk2nuObj);
-          const bsim::NuChoice& nuchoiceObj = dk2nuDriver->GetNuChoice();
-          nuchoicecol->push_back(nuchoiceObj);
-
-          if ( (fDebugFlags & 0x10 ) != 0 ) {
-            std::cout << "---------==== creation dump" << std::endl;
-            genie::EventRecord* gevtrec = fGENIEHelp->GetGenieEventRecord();
-            if ( gevtrec     ) std::cout << *gevtrec << std::endl;
-            std::cout << dk2nuObj << std::endl;
-            const bsim::Decay& decay = dk2nuObj.decay;
-            std::cout << " necm " << decay.necm
-                      << " muparp4 " << decay.muparpx << " "
-                      << decay.muparpy << " " << decay.muparpz << " "
-                      << decay.mupare << std::endl;
-            std::cout << nuchoiceObj << std::endl;
-          }
+          dk2nuPtr    = &(dk2nuDriver->GetDk2Nu());
+          nuchoicePtr = &(dk2nuDriver->GetNuChoice());
+        }
+      }
+      if ( dk2nuPtr && nuchoicePtr ) {
+        const bsim::Dk2Nu& dk2nuObj = *dk2nuPtr;
+        dk2nucol   ->push_back(dk2nuObj);
+        const bsim::NuChoice& nuchoiceObj = *nuchoicePtr;
+        nuchoicecol->push_back(nuchoiceObj);
+
+        if ( (fDebugFlags & 0x10 ) != 0 ) {
+          std::cout << "---------==== creation dump" << std::endl;
+          genie::EventRecord* gevtrec = fGENIEHelp->GetGenieEventRecord();
+          if ( gevtrec     ) std::cout << *gevtrec << std::endl;
+          std::cout << dk2nuObj << std::endl;
+          const bsim::Decay& decay = dk2nuObj.decay;
+          std::cout << " necm " << decay.necm
+                    << " muparp4 " << decay.muparpx << " "
+                    << decay.muparpy << " " << decay.muparpz << " "
+                    << decay.mupare << std::endl;
+          std::cout << nuchoiceObj << std::endl;
+        }
 
 #ifdef PUT_DK2NU_ASSN
-          evgb::util::CreateAssn(*this, evt, *truthcol, *dk2nucol, *dk2nuassn,
-                                 dk2nucol->size()-1, dk2nucol->size());
-          evgb::util::CreateAssn(*this, evt, *truthcol, *nuchoicecol, *nuchoiceassn,
-                                 nuchoicecol->size()-1, nuchoicecol->size());
+        evgb::util::CreateAssn(*this, evt, *truthcol, *dk2nucol, *dk2nuassn,
+                               dk2nucol->size()-1, dk2nucol->size(), indx);
+        evgb::util::CreateAssn(*this, evt, *truthcol, *nuchoicecol, *nuchoiceassn,
+                               nuchoicecol->size()-1, nuchoicecol->size(), indx);
 #endif
-        }
-        //--- END
-
-        std::cerr << " *** TestGENIEHelper::produce() sample success size "
-                  << truthcol->size()
-                  << std::endl << std::flush;
-        //RWH//if ( dk2nuDriver ) { std::cout << dk2nuDriver->GetDk2Nu() << std::endl; }
-        std::cout << " stopwatch after push_back + CreateAssn ";
-        fStopwatch.Print("um"); fStopwatch.Continue();
-        std::cout << std::flush;
-
-
-      } // end if genie was able to make an event
-
-    } // end event generation loop
+      }
+      //--- END
+    };
+
+    // the whole spill in one call; GENIEHelper drops rays that didn't
+    // produce an interaction in the detector
+    size_t nadded = fGENIEHelp->SampleBatch(0, *truthcol, *fluxcol, *gtruthcol,
+                                            onEvent);
+    mf::LogDebug("TestGENIEHelper") << "produce() sampled " << nadded << " events";
 
     // put the collections in the event
     evt.put(std::move(truthcol));
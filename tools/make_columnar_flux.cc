@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  make_columnar_flux.cc
+/// \brief Convert gsimple/dk2nu/gnumi flux files to an
+///        evgb::ColumnarFluxFile for FluxType "tree_columnar"
+///
+///   make_columnar_flux -t dk2nu -l <detloc> [-x xmlbase] [-n nrays] [-c ncycles]
+///                      [-s seed] [-k] [--no-parentage]
+///                      -o out.cflux | -d projdir  file.root [...]
+///
+///   The rays are thrown by the usual GENIE flux driver (weighted, one
+///   pass through the files, or ncycles passes for dk2nu style drivers
+///   that pick a new window point each time) for the given detector
+///   location, so they come out in that driver's user coordinates with
+///   its decay distances.  The driver's exposure grows by (POT per entry)
+///   / (max weight) for every entry, so the weights are written divided
+///   by its max weight and the POT is that exposure; drivers that don't
+///   report a max weight are thrown unweighted instead (rejected rays
+///   are then not kept).  Parentage columns and the flux type recorded
+///   in the header come from evgb::FillMCFlux().
+///
+///   With -k the written file is checked: it is replayed unweighted by
+///   GColumnarFlux and the inputs are thrown unweighted by the original
+///   driver, and the two rates (rays per POT, which sets the events per
+///   POT) have to agree within the statistical error.
+///
+///   -x sets the driver's XML config file (GFluxFileConfigI::SetXMLFileBase,
+///   where detloc is looked up) instead of the driver's default.
+///
+///   With -d each input is projected to its own file in projdir, named
+///   for the location and window (GColumnarFlux::ProjectedFileName), which
+///   is where GENIEHelper's ProjectedFluxDir looks for them; the name
+///   includes the XML config, so a job only finds them if its driver
+///   reads the same one.
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "TLorentzVector.h"
+
+#include "GENIE/Framework/EventGen/GFluxI.h"
+#include "GENIE/Framework/Numerical/RandomGen.h"
+#include "GENIE/Tools/Flux/GFluxDriverFactory.h"
+#include "GENIE/Tools/Flux/GFluxExposureI.h"
+#include "GENIE/Tools/Flux/GFluxFileConfigI.h"
+#include "GENIE/Tools/Flux/GNuMIFlux.h"
+#include "GENIE/Tools/Flux/GSimpleNtpFlux.h"
+
+#include "dk2nu/genie/GDk2NuFlux.h"
+
+#include "nusimdata/SimulationBase/MCFlux.h"
+
+#include "nugen/EventGeneratorBase/GENIE/ColumnarFluxFile.h"
+#include "nugen/EventGeneratorBase/GENIE/GColumnarFlux.h"
+#include "nugen/EventGeneratorBase/GENIE/GENIE2ART.h"
+
+namespace {
+
+  void Usage(const char* prog)
+  {
+    std::cerr
+      << "usage: " << prog << " -t simple|dk2nu|numi|<genie::flux::class> -l detloc\n"
+      << "         [-x xmlbase (driver's XML config, default the driver's own)]\n"
+      << "         [-n max rays (0 = all)] [-c passes (default 1)] [-s seed]\n"
+      << "         [-k (check rays per POT against the driver)]\n"
+      << "         [--no-parentage] -o out.cflux | -d projdir  file.root [file.root ...]\n";
+  }
+
+  // not every GENIE version has GetMaxWeight() on every driver
+  template <typename T, typename = void>
+  struct HasMaxWeight : std::false_type {};
+  template <typename T>
+  struct HasMaxWeight<T, std::void_t<decltype(std::declval<T&>().GetMaxWeight())> >
+    : std::true_type {};
+
+  template <typename T>
+  double MaxWeightOf(genie::GFluxI* driver)
+  {
+    T* d = dynamic_cast<T*>(driver);
+    if ( ! d ) return 0;
+    if constexpr ( HasMaxWeight<T>::value ) return d->GetMaxWeight();
+    else return 0;
+  }
+
+  /// the driver's current max weight (0 if it can't say)
+  double MaxWeight(genie::GFluxI* driver)
+  {
+    double wmax = MaxWeightOf<genie::flux::GSimpleNtpFlux>(driver);
+    if ( wmax <= 0 ) wmax = MaxWeightOf<genie::flux::GNuMIFlux>(driver);
+    if ( wmax <= 0 ) wmax = MaxWeightOf<genie::flux::GDk2NuFlux>(driver);
+    return wmax;
+  }
+
+  /// file based driver with the files loaded, nullptr (and a message) if not
+  genie::GFluxI* LoadDriver(std::string const& driverName,
+                            std::vector<std::string> const& inputs,
+                            std::string const& detloc, std::string const& xmlbase,
+                            long int ncycles)
+  {
+    genie::GFluxI* driver = ( driverName == "genie::flux::GColumnarFlux" ) ?
+      new genie::flux::GColumnarFlux :
+      genie::flux::GFluxDriverFactory::Instance().GetFluxDriver(driverName);
+    genie::flux::GFluxFileConfigI* fileconfig =
+      dynamic_cast<genie::flux::GFluxFileConfigI*>(driver);
+    if ( ! fileconfig || ! dynamic_cast<genie::flux::GFluxExposureI*>(driver) ) {
+      std::cerr << "no file based flux driver " << driverName << "\n";
+      delete driver;
+      return nullptr;
+    }
+    if ( xmlbase != "" ) fileconfig->SetXMLFileBase(xmlbase);
+    fileconfig->LoadBeamSimData(inputs,detloc);
+    fileconfig->SetNumOfCycles(ncycles);
+    return driver;
+  }
+
+  std::string DriverName(std::string const& type)
+  {
+    if ( type.find("genie::flux::") == 0 ) return type;
+    if ( type.find("simple") != std::string::npos ) return "genie::flux::GSimpleNtpFlux";
+    if ( type.find("dk2nu")  != std::string::npos ) return "genie::flux::GDk2NuFlux";
+    if ( type.find("numi")   != std::string::npos ||
+         type.find("ntuple") != std::string::npos ) return "genie::flux::GNuMIFlux";
+    return "";
+  }
+
+  /// throw one pass (ncycles passes) of rays and write them out
+  bool Convert(std::string const& driverName, std::vector<std::string> const& inputs,
+               std::string const& detloc, std::string const& xmlbase,
+               long int maxrays, long int ncycles,
+               bool parentage, std::string& output, std::string const& projdir)
+  {
+    typedef evgb::ColumnarFluxFile CFF;
+
+    genie::GFluxI* driver = LoadDriver(driverName,inputs,detloc,xmlbase,ncycles);
+    if ( ! driver ) return false;
+    genie::flux::GFluxFileConfigI* fileconfig =
+      dynamic_cast<genie::flux::GFluxFileConfigI*>(driver);
+    genie::flux::GFluxExposureI* exposure =
+      dynamic_cast<genie::flux::GFluxExposureI*>(driver);
+    fileconfig->PrintConfig();
+    // keep all the rays (GColumnarFlux does its own accept/reject) if
+    // the weights can be put on the scale of the driver's exposure
+    bool weighted = ( MaxWeight(driver) > 0 );
+    if ( ! weighted ) {
+      std::cout << driverName << " has no max weight, writing unweighted rays\n";
+    }
+    driver->GenerateWeighted(weighted);
+
+    if ( projdir != "" ) {
+      std::string key =
+        genie::flux::GColumnarFlux::ProjectionKey(detloc,fileconfig->GetXMLFileBase());
+      output = genie::flux::GColumnarFlux::ProjectedFileName(projdir,inputs[0],key);
+    }
+
+    std::vector< std::vector<float> > columns(CFF::kNColumns);
+    auto add = [&columns](CFF::Column_t c, double v) { columns[c].push_back(v); };
+
+    simb::MCFlux mcflux;
+    long int nrays = 0;
+    while ( ( maxrays <= 0 || nrays < maxrays ) && driver->GenerateNext() ) {
+      evgb::FillMCFlux(driver,mcflux);
+      const TLorentzVector& p4 = driver->Momentum();
+      const TLorentzVector& x4 = driver->Position();
+      // the max weight as of this entry is what its exposure was divided by
+      double wgt = driver->Weight();
+      if ( weighted ) wgt /= MaxWeight(driver);
+      add(CFF::kPdg,  driver->PdgCode());
+      add(CFF::kWgt,  wgt);
+      add(CFF::kE,    p4.E());
+      add(CFF::kPx,   p4.Px());
+      add(CFF::kPy,   p4.Py());
+      add(CFF::kPz,   p4.Pz());
+      add(CFF::kX,    x4.X());
+      add(CFF::kY,    x4.Y());
+      add(CFF::kZ,    x4.Z());
+      add(CFF::kDist, mcflux.fdk2gen);
+      if ( parentage ) {
+        add(CFF::kPtype,    mcflux.fptype);
+        add(CFF::kNdecay,   mcflux.fndecay);
+        add(CFF::kPpmedium, mcflux.fppmedium);
+        add(CFF::kTptype,   mcflux.ftptype);
+        add(CFF::kVx,       mcflux.fvx);
+        add(CFF::kVy,       mcflux.fvy);
+        add(CFF::kVz,       mcflux.fvz);
+        add(CFF::kPdpx,     mcflux.fpdpx);
+        add(CFF::kPdpy,     mcflux.fpdpy);
+        add(CFF::kPdpz,     mcflux.fpdpz);
+        add(CFF::kPppx,     mcflux.fppdxdz*mcflux.fpppz);
+        add(CFF::kPppy,     mcflux.fppdydz*mcflux.fpppz);
+        add(CFF::kPppz,     mcflux.fpppz);
+        add(CFF::kTpx,      mcflux.ftpx);
+        add(CFF::kTpy,      mcflux.ftpy);
+        add(CFF::kTpz,      mcflux.ftpz);
+      }
+      ++nrays;
+    }
+
+    double pot = exposure->GetTotalExposure();
+    delete driver;
+    if ( ! CFF::Write(output,columns,pot,mcflux.fFluxType) ) {
+      std::cerr << "failed to write " << output << "\n";
+      return false;
+    }
+    std::cout << "wrote " << nrays << " rays (" << pot << " POT) to " << output << "\n";
+    return true;
+  }
+
+  /// throw unweighted rays until the driver runs out; sum of weights per POT
+  bool RaysPerPOT(genie::GFluxI* driver, double& rate, double& error)
+  {
+    double sumw = 0, sumw2 = 0;
+    driver->GenerateWeighted(false);
+    while ( driver->GenerateNext() ) {
+      double wgt = driver->Weight();
+      sumw  += wgt;
+      sumw2 += wgt*wgt;
+    }
+    double pot = dynamic_cast<genie::flux::GFluxExposureI*>(driver)->GetTotalExposure();
+    delete driver;
+    if ( pot <= 0 ) return false;
+    rate  = sumw/pot;
+    error = std::sqrt(sumw2)/pot;
+    return true;
+  }
+
+  /// does the columnar file give the original driver's rays per POT?
+  bool Check(std::string const& driverName, std::vector<std::string> const& inputs,
+             std::string const& detloc, std::string const& xmlbase, long int ncycles,
+             std::string const& output)
+  {
+    genie::GFluxI* source   = LoadDriver(driverName,inputs,detloc,xmlbase,ncycles);
+    // GColumnarFlux starts at a random ray; two cycles is at least one full pass
+    genie::GFluxI* columnar = LoadDriver("genie::flux::GColumnarFlux",
+                                         std::vector<std::string>(1,output),detloc,"",2);
+    double rsrc = 0, esrc = 0, rcol = 0, ecol = 0;
+    bool ok = ( source && columnar );
+    if ( ok ) ok = RaysPerPOT(source,rsrc,esrc) && RaysPerPOT(columnar,rcol,ecol);
+    else { delete source; delete columnar; }
+    if ( ! ok ) {
+      std::cerr << "check of " << output << ": no exposure to compare\n";
+      return false;
+    }
+    double pull = ( rcol - rsrc ) / std::sqrt( esrc*esrc + ecol*ecol );
+    ok = ( std::abs(pull) < 4 );
+    std::cout << "check of " << output << ": " << rcol << " +/- " << ecol
+              << " rays/POT, " << driverName << " " << rsrc << " +/- " << esrc
+              << " (" << pull << " sigma) " << ( ok ? "OK" : "FAILED" ) << "\n";
+    return ok;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  std::string type, detloc, xmlbase, output, projdir;
+  long int    maxrays   = 0;
+  long int    ncycles   = 1;
+  long int    seed      = -1;
+  bool        parentage = true;
+  bool        check     = false;
+  std::vector<std::string> inputs;
+
+  for ( int i = 1; i < argc; ++i ) {
+    std::string arg = argv[i];
+    bool hasval = ( i+1 < argc );
+    if      ( arg == "-t" && hasval ) type    = argv[++i];
+    else if ( arg == "-l" && hasval ) detloc  = argv[++i];
+    else if ( arg == "-x" && hasval ) xmlbase = argv[++i];
+    else if ( arg == "-o" && hasval ) output  = argv[++i];
+    else if ( arg == "-d" && hasval ) projdir = argv[++i];
+    else if ( arg == "-n" && hasval ) maxrays = std::atol(argv[++i]);
+    else if ( arg == "-c" && hasval ) ncycles = std::atol(argv[++i]);
+    else if ( arg == "-s" && hasval ) seed    = std::atol(argv[++i]);
+    else if ( arg == "-k" ) check = true;
+    else if ( arg == "--no-parentage" ) parentage = false;
+    else if ( arg == "-h" || arg == "--help" ) { Usage(argv[0]); return 0; }
+    else inputs.push_back(arg);
+  }
+  std::string driverName = DriverName(type);
+  if ( driverName == "" || ( output == "" && projdir == "" ) || inputs.empty() ) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  if ( seed >= 0 ) genie::RandomGen::Instance()->SetSeed(seed);
+
+  if ( projdir == "" ) {
+    if ( ! Convert(driverName,inputs,detloc,xmlbase,maxrays,ncycles,parentage,output,"") ) return 1;
+    return ( ! check || Check(driverName,inputs,detloc,xmlbase,ncycles,output) ) ? 0 : 3;
+  }
+
+  // one projected file per input, named for the location & window
+  int nbad = 0, nfailed = 0;
+  for ( auto const& input : inputs ) {
+    std::vector<std::string> one(1,input);
+    std::string projected;
+    if ( ! Convert(driverName,one,detloc,xmlbase,maxrays,ncycles,parentage,projected,projdir) ) ++nbad;
+    else if ( check && ! Check(driverName,one,detloc,xmlbase,ncycles,projected) ) ++nfailed;
+  }
+  if ( nbad > 0 ) return 2;
+  return ( nfailed == 0 ) ? 0 : 3;
+}
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  make_flux_manifest.cc
+/// \brief Write an evgb::FluxManifest for a set of flux files
+///
+///   make_flux_manifest [-o evgb_flux_manifest.txt] file.root [file.root ...]
+///
+///   Understands dk2nu (dk2nuTree/dkmetaTree), gsimple (flux/meta) and
+///   gnumi (h10) files; for gnumi the POT and flavors are left unknown.
+///   The manifest is meant to live in the same directory as the files.
+///
+////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeFormula.h"
+
+#include "nugen/EventGeneratorBase/GENIE/FluxManifest.h"
+
+namespace {
+
+  void Usage(const char* prog)
+  {
+    std::cerr << "usage: " << prog << " [-o manifest] file.root [file.root ...]\n"
+              << "  default manifest name is " << evgb::FluxManifest::kDefaultName << "\n";
+  }
+
+  /// sum of a per-entry quantity over a whole tree
+  double SumOf(TTree* tree, const char* expr)
+  {
+    TTreeFormula formula("sum",expr,tree);
+    if ( formula.GetNdim() == 0 ) return 0;
+    double sum = 0;
+    for ( Long64_t i = 0; i < tree->GetEntries(); ++i ) {
+      tree->LoadTree(i);
+      formula.GetNdata();
+      sum += formula.EvalInstance(0);
+    }
+    return sum;
+  }
+
+  /// entries, energy range and flavor counts from a flux tree
+  void Summarize(TTree* tree, const char* pdgexpr, const char* eexpr,
+                 evgb::FluxManifestEntry& entry)
+  {
+    entry.entries = tree->GetEntries();
+    TTreeFormula fpdg("pdg",pdgexpr,tree);
+    TTreeFormula fe("e",eexpr,tree);
+    if ( fpdg.GetNdim() == 0 || fe.GetNdim() == 0 ) return;
+
+    double emin = std::numeric_limits<double>::max();
+    double emax = 0;
+    for ( Long64_t i = 0; i < entry.entries; ++i ) {
+      tree->LoadTree(i);
+      fpdg.GetNdata();
+      fe.GetNdata();
+      int    pdg = (int)fpdg.EvalInstance(0);
+      double e   = fe.EvalInstance(0);
+      ++entry.flavors[pdg];
+      if ( e < emin ) emin = e;
+      if ( e > emax ) emax = e;
+    }
+    if ( entry.entries > 0 ) {
+      entry.emin = emin;
+      entry.emax = emax;
+    }
+  }
+
+  bool Describe(std::string const& fname, evgb::FluxManifestEntry& entry)
+  {
+    entry.file = fname;
+    struct stat sb;
+    if ( stat(fname.c_str(),&sb) != 0 ) return false;
+    entry.bytes = sb.st_size;
+
+    std::unique_ptr<TFile> file(TFile::Open(fname.c_str(),"READ"));
+    if ( ! file || file->IsZombie() ) return false;
+
+    if ( TTree* tree = dynamic_cast<TTree*>(file->Get("dk2nuTree")) ) {
+      // nuray[0] is the ray in a random direction
+      Summarize(tree,"decay.ntype","nuray[0].E",entry);
+      if ( TTree* meta = dynamic_cast<TTree*>(file->Get("dkmetaTree")) ) {
+        entry.pot = SumOf(meta,"pots");
+      }
+    } else if ( TTree* tree = dynamic_cast<TTree*>(file->Get("flux")) ) {
+      Summarize(tree,"entry.pdg","entry.E",entry);
+      if ( TTree* meta = dynamic_cast<TTree*>(file->Get("meta")) ) {
+        entry.pot = SumOf(meta,"protons");
+      }
+    } else if ( TTree* tree = dynamic_cast<TTree*>(file->Get("h10")) ) {
+      // Ntype is a geant code and the POT isn't stored; entries only
+      entry.entries = tree->GetEntries();
+    } else {
+      std::cerr << fname << ": no dk2nu, gsimple or gnumi tree\n";
+      return false;
+    }
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  std::string output = evgb::FluxManifest::kDefaultName;
+  std::vector<std::string> inputs;
+  for ( int i = 1; i < argc; ++i ) {
+    std::string arg = argv[i];
+    if ( arg == "-o" && i+1 < argc ) {
+      output = argv[++i];
+    } else if ( arg == "-h" || arg == "--help" ) {
+      Usage(argv[0]);
+      return 0;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if ( inputs.empty() ) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<evgb::FluxManifestEntry> entries;
+  int nbad = 0;
+  for ( auto const& fname : inputs ) {
+    evgb::FluxManifestEntry entry;
+    if ( ! Describe(fname,entry) ) {
+      std::cerr << "skipping " << fname << "\n";
+      ++nbad;
+      continue;
+    }
+    std::cout << evgb::FluxManifest::FormatLine(entry) << "\n";
+    entries.push_back(entry);
+  }
+
+  std::string tmp = output + ".tmp";
+  {
+    std::ofstream out(tmp.c_str());
+    evgb::FluxManifest::Write(out,entries);
+    if ( ! out ) {
+      std::cerr << "failed to write " << tmp << "\n";
+      return 1;
+    }
+  }
+  if ( std::rename(tmp.c_str(),output.c_str()) != 0 ) {
+    std::cerr << "failed to rename " << tmp << " to " << output << "\n";
+    return 1;
+  }
+  std::cout << "wrote " << entries.size() << " files to " << output << "\n";
+  return ( nbad == 0 ) ? 0 : 2;
+}